@@ -0,0 +1,385 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_METISCSRFILE_HPP
+#define MYCPPPITFALLS_METISCSRFILE_HPP
+
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include "MetisLoader.hpp"
+
+
+/*
+磁盘上的METIS CSR文件(out-of-core)：图比内存大时，流式读取METIS文本，把xadj/adjncy/vwgt/vsize/adjwgt直接写入文件，
+之后内存映射打开，数组由操作系统按需调页，不占用堆内存.
+布局(本机字节序)：MetisCsrHeader | xadj | adjncy | vwgt | vsize | adjwgt，元素为idx_t，
+每段起始按64字节对齐，头部记录各段偏移、字节数与FNV-1a校验和，头部自身也有校验和；不存在的数组字节数为0.
+*/
+struct MetisCsrHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t idx_bytes; // sizeof(idx_t)，打开时必须一致
+	uint32_t fmt;
+	uint64_t nvtxs;
+	uint64_t nedges;    // 无向边数，adjncy元素数为2*nedges
+	uint64_t ncon;
+	uint64_t section_offset[5];
+	uint64_t section_bytes[5];
+	uint64_t section_checksum[5];
+	uint64_t header_checksum;
+};
+
+namespace metis_csr {
+	enum Section { XADJ, ADJNCY, VWGT, VSIZE, ADJWGT, SECTION_NUM };
+
+	constexpr uint32_t version = 1;
+	constexpr uint64_t align = 64;
+
+	inline const char* magic() { return "MCSR"; }
+
+	inline uint64_t align_up(uint64_t pos) { return (pos + align - 1) / align * align; }
+
+	inline uint64_t fnv1a(const void* data, size_t bytes, uint64_t h = 14695981039346656037ull) {
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < bytes; ++i) {
+			h ^= p[i];
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// 输入的分块读取：缓冲区固定大小，跨块的数字与行无需特殊处理
+	class Reader {
+	public:
+		Reader(const std::string& path, size_t buf_bytes) : in(path, std::ios::binary), buf(std::max<size_t>(buf_bytes, 4096)), pos(0), len(0) {}
+
+		bool good() const { return static_cast<bool>(in) || len > 0; }
+
+		int peek() {
+			if (pos == len && !refill()) return -1;
+			return static_cast<unsigned char>(buf[pos]);
+		}
+
+		void skip() { ++pos; }
+
+		// 跳过行内空白后读一个整数；遇到换行或文件尾返回false；超出idx_t范围的数视为错误，与metis_io::next_int相同
+		bool next_int(idx_t& out, bool& bad) {
+			int c = peek();
+			while (c == ' ' || c == '\t' || c == '\r') {
+				skip();
+				c = peek();
+			}
+			if (c == -1 || c == '\n') return false;
+			bool neg = c == '-';
+			if (neg) {
+				skip();
+				c = peek();
+			}
+			if (c < '0' || c > '9') {
+				bad = true;
+				return false;
+			}
+			const int64_t limit = std::numeric_limits<idx_t>::max();
+			int64_t x = 0;
+			for (; c >= '0' && c <= '9'; c = peek()) {
+				x = x * 10 + (c - '0');
+				skip();
+				if (x > limit) {
+					bad = true;
+					return false;
+				}
+			}
+			if (c != -1 && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+				bad = true;
+				return false;
+			}
+			out = static_cast<idx_t>(neg ? -x : x);
+			return true;
+		}
+
+		// 跳过行首空白，返回该行是否为注释
+		bool rest_is_comment() {
+			int c = peek();
+			while (c == ' ' || c == '\t' || c == '\r') {
+				skip();
+				c = peek();
+			}
+			return c == '%';
+		}
+
+		void skip_line() {
+			for (int c = peek(); c != -1; c = peek()) {
+				skip();
+				if (c == '\n') return;
+			}
+		}
+
+		bool eof() { return peek() == -1; }
+
+	private:
+		bool refill() {
+			if (!in) return false;
+			in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+			len = static_cast<size_t>(in.gcount());
+			pos = 0;
+			return len > 0;
+		}
+
+	private:
+		std::ifstream in;
+		std::vector<char> buf;
+		size_t pos;
+		size_t len;
+	};
+
+	// 跳过注释读取头部"n m [fmt] [ncon]"，之后in停在第一行顶点数据的开头
+	inline bool read_header(Reader& in, idx_t& n, idx_t& m, int& fmt, idx_t& ncon) {
+		while (in.rest_is_comment()) { in.skip_line(); }
+		std::string head;
+		for (int c = in.peek(); c != -1 && c != '\n'; c = in.peek()) {
+			head.push_back(static_cast<char>(c));
+			in.skip();
+		}
+		in.skip_line();
+		const char* p = head.data();
+		const char* head_end = p + head.size();
+		bool bad = false;
+		if (!metis_io::next_int(p, head_end, n, bad) || !metis_io::next_int(p, head_end, m, bad) || n < 0 || m < 0) return false;
+		fmt = metis_io::parse_fmt(p, head_end, bad);
+		if (!bad && !metis_io::next_int(p, head_end, ncon, bad)) ncon = 1;
+		return !bad && ncon >= 1;
+	}
+
+	// 输出段：缓冲满后写到该段在文件中的当前位置，同时累计校验和
+	class SectionWriter {
+	public:
+		SectionWriter() : out(nullptr), pos(0), hash(fnv1a(nullptr, 0)) {}
+
+		void init(std::fstream* file, uint64_t offset, size_t buf_elems) {
+			out = file;
+			pos = offset;
+			buf.reserve(std::max<size_t>(buf_elems, 1024));
+		}
+
+		void put(idx_t x) {
+			buf.push_back(x);
+			if (buf.size() == buf.capacity()) flush();
+		}
+
+		void flush() {
+			if (buf.empty()) return;
+			size_t bytes = buf.size() * sizeof(idx_t);
+			hash = fnv1a(buf.data(), bytes, hash);
+			out->seekp(static_cast<std::streamoff>(pos));
+			out->write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(bytes));
+			pos += bytes;
+			buf.clear();
+		}
+
+		uint64_t checksum() const { return hash; }
+
+	private:
+		std::fstream* out;
+		uint64_t pos;
+		uint64_t hash;
+		std::vector<idx_t> buf;
+	};
+}
+
+/*
+流式构建：只读一遍METIS文本，按头部的n、m预先算出各段在输出文件中的位置，
+每个数组各有一个写缓冲，满了就写到自己的段中，内存占用约为memory_budget，与图的大小无关.
+内存预算的一半作为读缓冲，另一半平分给各输出段.
+解析规则与load_metis相同；邻居数与头部不符时失败并删除输出文件.
+*/
+inline bool stream_metis_csr(const std::string& graph_path, const std::string& csr_path, size_t memory_budget, std::string* error = nullptr) {
+	using namespace metis_csr;
+	auto fail = [&](const std::string& msg) {
+		if (error) *error = msg;
+		return false;
+	};
+	Reader in(graph_path, memory_budget / 2);
+	if (!in.good()) return fail("cannot open " + graph_path);
+	idx_t n = 0, m = 0, ncon = 1;
+	int fmt = 0;
+	if (!read_header(in, n, m, fmt, ncon)) return fail("bad header");
+	bool bad = false;
+
+	const bool has_vsize = (fmt & VERTEX_SIZE) != 0;
+	const bool has_vwgt = (fmt & VERTEX_WEIGHT) != 0;
+	const bool has_ewgt = (fmt & EDGE_WEIGHT) != 0;
+	const uint64_t adj_num = 2 * static_cast<uint64_t>(m);
+	if (adj_num > static_cast<uint64_t>(std::numeric_limits<idx_t>::max())) return fail("graph too large for idx_t");
+	MetisCsrHeader h = {};
+	std::memcpy(h.magic, magic(), 4);
+	h.version = version;
+	h.idx_bytes = sizeof(idx_t);
+	h.fmt = static_cast<uint32_t>(fmt);
+	h.nvtxs = static_cast<uint64_t>(n);
+	h.nedges = static_cast<uint64_t>(m);
+	h.ncon = static_cast<uint64_t>(ncon);
+	uint64_t elems[SECTION_NUM] = { h.nvtxs + 1, adj_num, has_vwgt ? h.nvtxs * h.ncon : 0, has_vsize ? h.nvtxs : 0, has_ewgt ? adj_num : 0 };
+	uint64_t pos = align_up(sizeof(MetisCsrHeader));
+	for (int k = 0; k < SECTION_NUM; ++k) {
+		h.section_offset[k] = pos;
+		h.section_bytes[k] = elems[k] * sizeof(idx_t);
+		pos = align_up(pos + h.section_bytes[k]);
+	}
+
+	std::fstream out(csr_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out) return fail("cannot create " + csr_path);
+	SectionWriter sections[SECTION_NUM];
+	for (int k = 0; k < SECTION_NUM; ++k) { sections[k].init(&out, h.section_offset[k], memory_budget / 2 / SECTION_NUM / sizeof(idx_t)); }
+
+	uint64_t v = 0, e = 0;
+	while (!in.eof() && !bad) {
+		if (in.rest_is_comment()) {
+			in.skip_line();
+			continue;
+		}
+		idx_t x = 0;
+		if (v >= h.nvtxs) { // 只允许空行
+			if (in.next_int(x, bad)) bad = true;
+			in.skip_line();
+			continue;
+		}
+		sections[XADJ].put(static_cast<idx_t>(e));
+		uint64_t k = 0;
+		uint64_t prefix = (has_vsize ? 1 : 0) + (has_vwgt ? h.ncon : 0);
+		uint64_t stride = has_ewgt ? 2 : 1;
+		for (; in.next_int(x, bad); ++k) {
+			if (k < prefix) {
+				sections[has_vsize && k == 0 ? VSIZE : VWGT].put(x);
+			}
+			else if ((k - prefix) % stride == 0) {
+				if (x < 1 || x > n || e == adj_num) {
+					bad = true;
+					break;
+				}
+				sections[ADJNCY].put(x - 1); // 节点id从0开始
+				++e;
+			}
+			else {
+				sections[ADJWGT].put(x);
+			}
+		}
+		if (k == 0) { // 空行：没有邻居，属性取默认值
+			if (has_vsize) sections[VSIZE].put(1);
+			for (uint64_t c = 0; has_vwgt && c < h.ncon; ++c) { sections[VWGT].put(1); }
+		}
+		else if (k < prefix || (k - prefix) % stride != 0) {
+			bad = true;
+		}
+		in.skip_line();
+		++v;
+	}
+	for (; v < h.nvtxs && !bad; ++v) { // 缺少的末尾行视为没有邻居的顶点
+		sections[XADJ].put(static_cast<idx_t>(e));
+		if (has_vsize) sections[VSIZE].put(1);
+		for (uint64_t c = 0; has_vwgt && c < h.ncon; ++c) { sections[VWGT].put(1); }
+	}
+	sections[XADJ].put(static_cast<idx_t>(e));
+	if (bad || e != adj_num) {
+		out.close();
+		std::remove(csr_path.c_str());
+		return fail(bad ? "bad number, token count or neighbour id" : "edge count does not match header");
+	}
+	for (int k = 0; k < SECTION_NUM; ++k) {
+		sections[k].flush();
+		h.section_checksum[k] = sections[k].checksum();
+	}
+	h.header_checksum = fnv1a(&h, offsetof(MetisCsrHeader, header_checksum));
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	if (!out) return fail("write failed");
+	return true;
+}
+
+
+/*
+内存映射打开stream_metis_csr生成的文件，各数组以const idx_t*给出，不复制到堆上.
+idx_t为32位时，xadj/adjncy/adjwgt可直接作为CsrAdj::view的offsets/targets/weights供最短路使用.
+*/
+class MetisCsrFile {
+public:
+	MetisCsrFile() : head() {}
+
+	/*
+	总是检查头部、各段边界与大小，以及xadj从0单调递增到2*nedges、adjncy都在[0, nvtxs)内(O(V+E))，
+	数据段损坏时打开失败，不会在划分或最短路中越界读；verify为true时再校验各段的校验和.
+	*/
+	bool open(const std::string& path, bool verify = false) {
+		using namespace metis_csr;
+		file.close();
+		if (!file.open(path) || file.size() < sizeof(MetisCsrHeader)) return false;
+		std::memcpy(&head, file.data(), sizeof(head));
+		if (std::memcmp(head.magic, magic(), 4) != 0 || head.version != version || head.idx_bytes != sizeof(idx_t)
+			|| head.header_checksum != fnv1a(&head, offsetof(MetisCsrHeader, header_checksum))) return close_fail();
+		for (int k = 0; k < SECTION_NUM; ++k) {
+			if (head.section_bytes[k] == 0) continue; // 不存在的数组，偏移可能超出文件末尾
+			if (head.section_offset[k] % align != 0 || head.section_offset[k] > file.size()
+				|| head.section_bytes[k] > file.size() - head.section_offset[k]) return close_fail();
+			if (verify && head.section_checksum[k] != fnv1a(file.data() + head.section_offset[k], static_cast<size_t>(head.section_bytes[k]))) return close_fail();
+		}
+		const uint64_t max_idx = static_cast<uint64_t>(std::numeric_limits<idx_t>::max());
+		if (head.nvtxs > max_idx || head.nedges > max_idx / 2 || head.ncon < 1 || head.ncon > max_idx) return close_fail();
+		const uint64_t n = head.nvtxs, adj_num = 2 * head.nedges;
+		const uint64_t elems[SECTION_NUM] = { n + 1, adj_num, (head.fmt & VERTEX_WEIGHT) ? n * head.ncon : 0,
+			(head.fmt & VERTEX_SIZE) ? n : 0, (head.fmt & EDGE_WEIGHT) ? adj_num : 0 };
+		for (int k = 0; k < SECTION_NUM; ++k) {
+			if (head.section_bytes[k] != elems[k] * sizeof(idx_t)) return close_fail();
+		}
+		const idx_t* x = xadj();
+		const idx_t* a = adjncy();
+		if (x[0] != 0 || static_cast<uint64_t>(x[n]) != adj_num) return close_fail();
+		for (uint64_t v = 0; v < n; ++v) {
+			if (x[v] > x[v + 1]) return close_fail();
+		}
+		for (uint64_t i = 0; i < adj_num; ++i) {
+			if (a[i] < 0 || static_cast<uint64_t>(a[i]) >= n) return close_fail();
+		}
+		return true;
+	}
+
+	idx_t nvtxs() const { return static_cast<idx_t>(head.nvtxs); }
+
+	idx_t nedges() const { return static_cast<idx_t>(head.nedges); }
+
+	idx_t ncon() const { return static_cast<idx_t>(head.ncon); }
+
+	int fmt() const { return static_cast<int>(head.fmt); }
+
+	const idx_t* xadj() const { return section(metis_csr::XADJ); }
+
+	const idx_t* adjncy() const { return section(metis_csr::ADJNCY); }
+
+	// 以下数组不存在时为nullptr
+	const idx_t* vwgt() const { return section(metis_csr::VWGT); }
+
+	const idx_t* vsize() const { return section(metis_csr::VSIZE); }
+
+	const idx_t* adjwgt() const { return section(metis_csr::ADJWGT); }
+
+private:
+	const idx_t* section(int k) const {
+		if (file.data() == nullptr || head.section_bytes[k] == 0) return nullptr;
+		return reinterpret_cast<const idx_t*>(file.data() + head.section_offset[k]);
+	}
+
+	bool close_fail() {
+		file.close();
+		head = MetisCsrHeader();
+		return false;
+	}
+
+private:
+	MappedFile file;
+	MetisCsrHeader head;
+};
+
+#endif // MYCPPPITFALLS_METISCSRFILE_HPP
@@ -0,0 +1,259 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_METISLOADER_HPP
+#define MYCPPPITFALLS_METISLOADER_HPP
+
+#include <metis.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+
+
+enum FmtBit {
+	EDGE_WEIGHT = 0x0001,
+	VERTEX_WEIGHT = 0x0002,
+	VERTEX_SIZE = 0x0004
+};
+
+/*
+METIS图文件：
+   头部 "n m [fmt] [ncon]"，fmt为三位0/1数字串(顶点大小, 顶点权重, 边权重)，ncon为顶点权重维数；
+   之后第i行描述顶点i：[vsize] [vwgt × ncon] 邻居1 [边权1] 邻居2 [边权2] ...，邻居编号从1开始；
+   以'%'开头的行为注释，空行表示没有邻居的顶点.
+解析结果直接是METIS_PartGraph*需要的CSR数组，编号从0开始，没有的数组为空.
+*/
+struct MetisGraph {
+	idx_t nvtxs = 0;
+	idx_t nedges = 0; // 头部的无向边数，adjncy大小为2*nedges
+	idx_t ncon = 1;
+	int fmt = 0;      // FmtBit组合
+	std::vector<idx_t> xadj;
+	std::vector<idx_t> adjncy;
+	std::vector<idx_t> vwgt;   // nvtxs*ncon
+	std::vector<idx_t> vsize;
+	std::vector<idx_t> adjwgt;
+};
+
+namespace metis_io {
+	inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+	// 跳过行内空白后读一个整数；行尾(或文件尾)返回false，p停在'\n'上；超出idx_t范围的数视为错误
+	inline bool next_int(const char*& p, const char* end, idx_t& out, bool& bad) {
+		while (p < end && is_blank(*p)) { ++p; }
+		if (p == end || *p == '\n') return false;
+		bool neg = *p == '-';
+		if (neg) ++p;
+		if (p == end || !is_digit(*p)) {
+			bad = true;
+			return false;
+		}
+		const int64_t limit = std::numeric_limits<idx_t>::max();
+		int64_t x = 0;
+		while (p < end && is_digit(*p)) {
+			x = x * 10 + (*p++ - '0');
+			if (x > limit) {
+				bad = true;
+				return false;
+			}
+		}
+		if (p < end && !is_blank(*p) && *p != '\n') {
+			bad = true;
+			return false;
+		}
+		out = static_cast<idx_t>(neg ? -x : x);
+		return true;
+	}
+
+	inline const char* line_end(const char* p, const char* end) {
+		while (p < end && *p != '\n') { ++p; }
+		return p;
+	}
+
+	inline bool is_comment(const char* p, const char* end) {
+		while (p < end && is_blank(*p)) { ++p; }
+		return p < end && *p == '%';
+	}
+
+	// 一行中的整数个数，只扫描不转换
+	inline size_t count_tokens(const char* p, const char* end) {
+		size_t n = 0;
+		bool in_token = false;
+		for (; p < end; ++p) {
+			bool blank = is_blank(*p);
+			if (!blank && !in_token) ++n;
+			in_token = !blank;
+		}
+		return n;
+	}
+
+	// fmt按数字串解析，"11"与"011"相同
+	inline int parse_fmt(const char*& p, const char* end, bool& bad) {
+		while (p < end && is_blank(*p)) { ++p; }
+		int fmt = 0;
+		int digits = 0;
+		for (; p < end && is_digit(*p); ++p, ++digits) {
+			if (*p > '1' || digits == 3) bad = true;
+			fmt = fmt << 1 | (*p - '0');
+		}
+		return fmt;
+	}
+}
+
+/*
+并行解析已读入内存(或映射)的METIS文本，data为整个文件内容.
+   1. 解析头部，按n、m预先分配CSR数组.
+   2. 把数据部分按字节均分为pool.size()*4块，块边界移到下一个换行之后，保证每块都是完整的行.
+   3. 第一遍各块并行统计行数与邻居数；前缀和得到每块的起始顶点与起始边下标.
+   4. 第二遍各块并行解析，直接写入自己的区间，无需合并.
+邻居总数与头部不符、编号越界、数字超出idx_t范围、行内数字个数与fmt不符时返回false，error给出原因.
+*/
+inline bool parse_metis(const char* data, size_t size, MetisGraph& g, ThreadPool& pool, std::string* error = nullptr) {
+	using namespace metis_io;
+	auto fail = [&](const std::string& msg) {
+		if (error) *error = msg;
+		return false;
+	};
+	const char* end = data + size;
+	const char* p = data;
+	while (p < end && is_comment(p, end)) { p = line_end(p, end) + 1; }
+	if (p >= end) return fail("missing header");
+	const char* head_end = line_end(p, end);
+	bool bad = false;
+	idx_t n = 0, m = 0;
+	if (!next_int(p, head_end, n, bad) || !next_int(p, head_end, m, bad) || n < 0 || m < 0) return fail("bad header");
+	g = MetisGraph();
+	g.nvtxs = n;
+	g.nedges = m;
+	g.fmt = parse_fmt(p, head_end, bad);
+	if (!bad && !next_int(p, head_end, g.ncon, bad)) g.ncon = 1;
+	if (bad || g.ncon < 1) return fail("bad header");
+	const uint64_t adj_num = 2 * static_cast<uint64_t>(m);
+	if (adj_num > static_cast<uint64_t>(std::numeric_limits<idx_t>::max())) return fail("graph too large for idx_t");
+	const char* body = head_end < end ? head_end + 1 : end;
+
+	const bool has_vsize = (g.fmt & VERTEX_SIZE) != 0;
+	const bool has_vwgt = (g.fmt & VERTEX_WEIGHT) != 0;
+	const bool has_ewgt = (g.fmt & EDGE_WEIGHT) != 0;
+	const size_t prefix = (has_vsize ? 1 : 0) + (has_vwgt ? static_cast<size_t>(g.ncon) : 0); // 行首的顶点属性个数
+	const size_t stride = has_ewgt ? 2 : 1;
+	g.xadj.resize(static_cast<size_t>(n) + 1);
+	g.adjncy.resize(static_cast<size_t>(adj_num));
+	if (has_ewgt) g.adjwgt.resize(g.adjncy.size());
+	if (has_vwgt) g.vwgt.resize(static_cast<size_t>(n) * g.ncon);
+	if (has_vsize) g.vsize.resize(static_cast<size_t>(n));
+
+	// 按行边界分块
+	size_t chunk_num = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(pool.size()) * 4, (end - body) / 4096 + 1));
+	std::vector<const char*> bounds(chunk_num + 1, end);
+	bounds[0] = body;
+	for (size_t k = 1; k < chunk_num; ++k) {
+		const char* q = body + (end - body) * k / chunk_num;
+		q = q > bounds[k - 1] ? q : bounds[k - 1];
+		if (q > body && q < end && q[-1] != '\n') {
+			q = line_end(q, end);
+			if (q < end) ++q;
+		}
+		bounds[k] = q;
+	}
+
+	// 第一遍：统计
+	std::vector<size_t> lines(chunk_num + 1, 0), entries(chunk_num + 1, 0);
+	std::vector<char> chunk_bad(chunk_num, 0);
+	pool.parallel_for(chunk_num, [&](size_t k, int) {
+		for (const char* q = bounds[k]; q < bounds[k + 1]; ) {
+			const char* e = line_end(q, bounds[k + 1]);
+			if (!is_comment(q, e)) {
+				size_t tokens = count_tokens(q, e);
+				if (tokens != 0 && (tokens < prefix || (tokens - prefix) % stride != 0)) chunk_bad[k] = 1;
+				else if (tokens != 0) entries[k + 1] += (tokens - prefix) / stride;
+				++lines[k + 1];
+			}
+			q = e + 1;
+		}
+	});
+	for (size_t k = 0; k < chunk_num; ++k) {
+		if (chunk_bad[k]) return fail("token count does not match fmt");
+		lines[k + 1] += lines[k];
+		entries[k + 1] += entries[k];
+	}
+	// 文件末尾多余的空行不计；缺少的末尾行视为没有邻居的顶点
+	if (entries[chunk_num] != g.adjncy.size()) return fail("edge count does not match header");
+
+	// 第二遍：解析，块k的顶点从lines[k]开始，边从entries[k]开始
+	pool.parallel_for(chunk_num, [&](size_t k, int) {
+		size_t v = lines[k], e = entries[k];
+		bool local_bad = false;
+		idx_t x = 0;
+		for (const char* q = bounds[k]; q < bounds[k + 1] && !local_bad; ++q) {
+			const char* le = line_end(q, bounds[k + 1]);
+			if (is_comment(q, le)) {
+				q = le;
+				continue;
+			}
+			if (v >= static_cast<size_t>(n)) { // 只允许空行
+				if (next_int(q, le, x, local_bad)) local_bad = true;
+				q = le;
+				continue;
+			}
+			g.xadj[v] = static_cast<idx_t>(e);
+			if (has_vsize && !next_int(q, le, g.vsize[v], local_bad)) { // 空行：没有邻居，属性取默认值
+				g.vsize[v] = 1;
+				if (has_vwgt) std::fill(g.vwgt.begin() + v * g.ncon, g.vwgt.begin() + (v + 1) * g.ncon, 1);
+			}
+			else if (has_vwgt && !next_int(q, le, g.vwgt[v * g.ncon], local_bad)) {
+				std::fill(g.vwgt.begin() + v * g.ncon, g.vwgt.begin() + (v + 1) * g.ncon, 1);
+			}
+			else {
+				for (idx_t c = 1; has_vwgt && c < g.ncon; ++c) { next_int(q, le, g.vwgt[v * g.ncon + c], local_bad); }
+				while (next_int(q, le, x, local_bad)) {
+					if (x < 1 || x > n) {
+						local_bad = true;
+						break;
+					}
+					g.adjncy[e] = x - 1; // 节点id从0开始
+					if (has_ewgt) next_int(q, le, g.adjwgt[e], local_bad);
+					++e;
+				}
+			}
+			++v;
+			q = le;
+		}
+		chunk_bad[k] = local_bad;
+	});
+	for (char b : chunk_bad) {
+		if (b) return fail("bad number or neighbour id out of range");
+	}
+	for (size_t v = std::min(lines[chunk_num], static_cast<size_t>(n)); v < static_cast<size_t>(n); ++v) {
+		g.xadj[v] = static_cast<idx_t>(g.adjncy.size());
+		if (has_vsize) g.vsize[v] = 1;
+		if (has_vwgt) std::fill(g.vwgt.begin() + v * g.ncon, g.vwgt.begin() + (v + 1) * g.ncon, 1);
+	}
+	g.xadj[n] = static_cast<idx_t>(g.adjncy.size());
+	return true;
+}
+
+// 内存映射读取文件后并行解析
+inline bool load_metis(const std::string& path, MetisGraph& g, ThreadPool& pool, std::string* error = nullptr) {
+	MappedFile file;
+	if (!file.open(path)) {
+		if (error) *error = "cannot open " + path;
+		return false;
+	}
+	return parse_metis(file.data(), file.size(), g, pool, error);
+}
+
+inline bool load_metis(const std::string& path, MetisGraph& g, int threads = 1, std::string* error = nullptr) {
+	ThreadPool pool(threads);
+	return load_metis(path, g, pool, error);
+}
+
+#endif // MYCPPPITFALLS_METISLOADER_HPP
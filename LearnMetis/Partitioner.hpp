@@ -0,0 +1,684 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_PARTITIONER_HPP
+#define MYCPPPITFALLS_PARTITIONER_HPP
+
+#include <metis.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <queue>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include "ThreadPool.hpp"
+
+
+struct PartitionOptions {
+	idx_t nparts = 2;
+	double imbalance = 0.03; // 各部分权重上限为(1+imbalance)*平均权重，与METIS默认的ufactor=30相同
+	idx_t coarsen_to = 20;   // 粗图顶点数不超过coarsen_to*nparts时停止粗化
+	int initial_trials = 8;  // 初始划分的尝试次数，取割边最小的
+	int refine_rounds = 10;  // 每层标签传播的最多轮数
+	uint32_t seed = 1;
+};
+
+struct PartitionResult {
+	std::vector<idx_t> part;
+	int64_t edge_cut = 0;
+	double balance = 0; // 最重部分权重/平均权重，1.0为完全均衡
+	int levels = 0;     // 粗化层数
+};
+
+
+// 割边权重和，每条无向边计一次，与METIS返回的objval相同；adjwgt为nullptr时边权为1
+inline int64_t edge_cut(idx_t nvtxs, const idx_t* xadj, const idx_t* adjncy, const idx_t* adjwgt, const idx_t* part) {
+	int64_t cut = 0;
+	for (idx_t v = 0; v < nvtxs; ++v) {
+		for (idx_t i = xadj[v]; i < xadj[v + 1]; ++i) {
+			if (part[adjncy[i]] != part[v]) cut += adjwgt ? adjwgt[i] : 1;
+		}
+	}
+	return cut / 2;
+}
+
+// part中的部分编号是否都在[0, nparts)内
+inline bool valid_partition(idx_t nvtxs, idx_t nparts, const idx_t* part) {
+	for (idx_t v = 0; v < nvtxs; ++v) {
+		if (part[v] < 0 || part[v] >= nparts) return false;
+	}
+	return true;
+}
+
+// 各权重维度上 最重部分权重/平均权重 的最大值；vwgt为nullptr时顶点权重为1，part须满足valid_partition
+inline double partition_balance(idx_t nvtxs, idx_t ncon, const idx_t* vwgt, idx_t nparts, const idx_t* part) {
+	double worst = 0;
+	for (idx_t c = 0; c < (vwgt ? ncon : 1); ++c) {
+		std::vector<int64_t> w(nparts, 0);
+		int64_t total = 0;
+		for (idx_t v = 0; v < nvtxs; ++v) {
+			idx_t x = vwgt ? vwgt[static_cast<size_t>(v) * ncon + c] : 1;
+			w[part[v]] += x;
+			total += x;
+		}
+		if (total > 0) worst = std::max(worst, static_cast<double>(*std::max_element(w.begin(), w.end())) * nparts / total);
+	}
+	return worst;
+}
+
+// 读取main.cpp写出的划分文件，每行"顶点编号(从1开始) 部分编号"，部分编号须在[0, nparts)内
+inline bool load_partition(const std::string& path, idx_t nparts, std::vector<idx_t>& part, std::string* error = nullptr) {
+	std::ifstream in(path);
+	if (!in) {
+		if (error) *error = "cannot open " + path;
+		return false;
+	}
+	part.clear();
+	long long i, p;
+	while (in >> i >> p) {
+		if (i != static_cast<long long>(part.size()) + 1 || p < 0) {
+			if (error) *error = "bad line for vertex " + std::to_string(part.size() + 1);
+			return false;
+		}
+		if (p >= nparts) {
+			if (error) *error = "part id out of range for vertex " + std::to_string(part.size() + 1);
+			return false;
+		}
+		part.push_back(static_cast<idx_t>(p));
+	}
+	if (!in.eof()) {
+		if (error) *error = "bad number";
+		return false;
+	}
+	return true;
+}
+
+// 按main.cpp的格式写出划分：每行"顶点编号(从1开始) 部分编号"
+inline bool save_partition(const std::string& path, const std::vector<idx_t>& part) {
+	std::ofstream out(path);
+	for (size_t i = 0; i < part.size() && out; ++i) { out << i + 1 << " " << part[i] << "\n"; }
+	return static_cast<bool>(out);
+}
+
+
+namespace mlpart {
+	// 多层划分中的一层图；最细一层直接引用调用者的数组，粗图持有自己的数组
+	struct Level {
+		idx_t n = 0;
+		const idx_t* xadj = nullptr;
+		const idx_t* adjncy = nullptr;
+		const idx_t* adjwgt = nullptr; // nullptr时边权为1
+		const idx_t* vwgt = nullptr;   // 多个权重维度已合并为一个
+		std::vector<idx_t> own_xadj, own_adjncy, own_adjwgt, own_vwgt;
+		std::vector<idx_t> cmap;       // 本层顶点 → 下一层(更粗)顶点
+
+		idx_t weight(idx_t i) const { return adjwgt ? adjwgt[i] : 1; }
+	};
+
+	inline uint32_t mix(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	inline size_t chunk_num(size_t n, const ThreadPool& pool) {
+		return std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(pool.size()) * 4, n / 1024 + 1));
+	}
+
+	// 按连续区间并行遍历[0, n)，fn(begin, end, tid)
+	template<typename F>
+	void for_range(ThreadPool& pool, size_t n, F fn) {
+		size_t chunks = chunk_num(n, pool);
+		pool.parallel_for(chunks, [&](size_t k, int tid) { fn(n * k / chunks, n * (k + 1) / chunks, tid); });
+	}
+
+	/*
+	并行重边匹配(handshake)：每轮各未匹配顶点提议边权最大的未匹配邻居(同权时按边的随机优先级)，互相提议的两点匹配.
+	局部最重的边一定是互相提议的，每轮都有进展；新匹配不足1%时停止.
+	提议与确认分为两个阶段，每个顶点只写自己的下标，无需加锁. 合并后的权重不超过max_vwgt，保证粗图仍可均衡划分.
+	group非空时只匹配group相同的两点，粗化后已有的划分仍可原样投影. 结束后未匹配的顶点match[v] = v.
+	*/
+	inline void heavy_edge_matching(const Level& g, idx_t max_vwgt, uint32_t seed, ThreadPool& pool, std::vector<idx_t>& match, const idx_t* group = nullptr) {
+		match.assign(g.n, -1);
+		std::vector<idx_t> proposal(g.n);
+		for (uint32_t round = 0; round < 16; ++round) {
+			uint32_t salt = mix(seed * 31 + round);
+			std::atomic<size_t> matched(0);
+			for_range(pool, g.n, [&](size_t b, size_t e, int) {
+				for (idx_t v = static_cast<idx_t>(b); v < static_cast<idx_t>(e); ++v) {
+					proposal[v] = -1;
+					if (match[v] != -1) continue;
+					idx_t best_w = 0;
+					uint32_t best_r = 0;
+					for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+						idx_t u = g.adjncy[i];
+						if (u == v || match[u] != -1 || g.vwgt[v] + g.vwgt[u] > max_vwgt || (group && group[u] != group[v])) continue;
+						idx_t w = g.weight(i);
+						uint32_t r = mix(mix(static_cast<uint32_t>(std::min(u, v)) ^ salt) + static_cast<uint32_t>(std::max(u, v))); // 两端看到的优先级相同
+						if (proposal[v] == -1 || w > best_w || (w == best_w && r > best_r)) {
+							proposal[v] = u;
+							best_w = w;
+							best_r = r;
+						}
+					}
+				}
+			});
+			for_range(pool, g.n, [&](size_t b, size_t e, int) {
+				size_t local = 0;
+				for (size_t v = b; v < e; ++v) {
+					idx_t u = proposal[v];
+					if (u != -1 && proposal[u] == static_cast<idx_t>(v)) {
+						match[v] = u;
+						++local;
+					}
+				}
+				matched.fetch_add(local, std::memory_order_relaxed);
+			});
+			if (matched.load() <= static_cast<size_t>(g.n) / 100) break; // 剩下的大多已无可匹配的邻居
+		}
+		for_range(pool, g.n, [&](size_t b, size_t e, int) {
+			for (size_t v = b; v < e; ++v) {
+				if (match[v] == -1) match[v] = static_cast<idx_t>(v);
+			}
+		});
+	}
+
+	/*
+	按匹配收缩为粗图：每对中编号小的顶点作为代表，分块前缀和得到粗顶点编号，写入g.cmap.
+	各块用线程私有的标记数组合并两个细顶点的邻接表，内部边丢弃，平行边权重相加；
+	各块先写入自己的缓冲区，再按前缀和并行拷贝到最终位置.
+	*/
+	inline std::unique_ptr<Level> contract(Level& g, const std::vector<idx_t>& match, ThreadPool& pool) {
+		size_t n = static_cast<size_t>(g.n);
+		size_t chunks = chunk_num(n, pool);
+		std::vector<size_t> reps(chunks + 1, 0);
+		pool.parallel_for(chunks, [&](size_t k, int) {
+			for (size_t v = n * k / chunks; v < n * (k + 1) / chunks; ++v) {
+				if (match[v] >= static_cast<idx_t>(v)) ++reps[k + 1];
+			}
+		});
+		for (size_t k = 0; k < chunks; ++k) { reps[k + 1] += reps[k]; }
+		size_t cn = reps[chunks];
+		std::vector<idx_t> fine(cn); // 粗顶点的代表
+		g.cmap.resize(n);
+		pool.parallel_for(chunks, [&](size_t k, int) {
+			size_t c = reps[k];
+			for (size_t v = n * k / chunks; v < n * (k + 1) / chunks; ++v) {
+				if (match[v] >= static_cast<idx_t>(v)) {
+					g.cmap[v] = static_cast<idx_t>(c);
+					fine[c++] = static_cast<idx_t>(v);
+				}
+			}
+		});
+		for_range(pool, n, [&](size_t b, size_t e, int) {
+			for (size_t v = b; v < e; ++v) {
+				if (match[v] < static_cast<idx_t>(v)) g.cmap[v] = g.cmap[match[v]];
+			}
+		});
+
+		std::unique_ptr<Level> c(new Level());
+		c->n = static_cast<idx_t>(cn);
+		c->own_xadj.resize(cn + 1);
+		c->own_vwgt.resize(cn);
+		size_t cchunks = chunk_num(cn, pool);
+		std::vector<std::vector<idx_t>> adj(cchunks), wgt(cchunks);
+		std::vector<std::vector<idx_t>> marker(pool.size()); // marker[tid][粗邻居] = 它在当前块缓冲区中的下标
+		pool.parallel_for(cchunks, [&](size_t k, int tid) {
+			std::vector<idx_t>& mark = marker[tid];
+			if (mark.size() != cn) mark.assign(cn, -1);
+			for (size_t cv = cn * k / cchunks; cv < cn * (k + 1) / cchunks; ++cv) {
+				size_t start = adj[k].size();
+				c->own_xadj[cv] = static_cast<idx_t>(start); // 块内偏移，拷贝时加上块的起点
+				idx_t members[2] = { fine[cv], match[fine[cv]] };
+				int member_num = members[0] == members[1] ? 1 : 2;
+				c->own_vwgt[cv] = 0;
+				for (int j = 0; j < member_num; ++j) {
+					idx_t v = members[j];
+					c->own_vwgt[cv] += g.vwgt[v];
+					for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+						idx_t cu = g.cmap[g.adjncy[i]];
+						if (cu == static_cast<idx_t>(cv)) continue;
+						if (mark[cu] == -1) {
+							mark[cu] = static_cast<idx_t>(adj[k].size());
+							adj[k].push_back(cu);
+							wgt[k].push_back(g.weight(i));
+						}
+						else {
+							wgt[k][mark[cu]] += g.weight(i);
+						}
+					}
+				}
+				for (size_t j = start; j < adj[k].size(); ++j) { mark[adj[k][j]] = -1; }
+			}
+		});
+		std::vector<size_t> offset(cchunks + 1, 0);
+		for (size_t k = 0; k < cchunks; ++k) { offset[k + 1] = offset[k] + adj[k].size(); }
+		c->own_adjncy.resize(offset[cchunks]);
+		c->own_adjwgt.resize(offset[cchunks]);
+		pool.parallel_for(cchunks, [&](size_t k, int) {
+			for (size_t cv = cn * k / cchunks; cv < cn * (k + 1) / cchunks; ++cv) { c->own_xadj[cv] += static_cast<idx_t>(offset[k]); }
+			std::copy(adj[k].begin(), adj[k].end(), c->own_adjncy.begin() + offset[k]);
+			std::copy(wgt[k].begin(), wgt[k].end(), c->own_adjwgt.begin() + offset[k]);
+		});
+		c->own_xadj[cn] = static_cast<idx_t>(offset[cchunks]);
+		c->xadj = c->own_xadj.data();
+		c->adjncy = c->own_adjncy.data();
+		c->adjwgt = c->own_adjwgt.data();
+		c->vwgt = c->own_vwgt.data();
+		return c;
+	}
+
+	inline int64_t level_cut(const Level& g, const std::vector<idx_t>& part) {
+		int64_t cut = 0;
+		for (idx_t v = 0; v < g.n; ++v) {
+			for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+				if (part[g.adjncy[i]] != part[v]) cut += g.weight(i);
+			}
+		}
+		return cut / 2;
+	}
+
+	// part须在[0, k)内：入口函数已检查外部传入的划分，内部生成的划分总在范围内
+	inline std::vector<int64_t> part_weights(const Level& g, idx_t k, const std::vector<idx_t>& part) {
+		std::vector<int64_t> pw(k, 0);
+		for (idx_t v = 0; v < g.n; ++v) { pw[part[v]] += g.vwgt[v]; }
+		return pw;
+	}
+
+	/*
+	贪心图生长二分：从随机种子开始，每次把"连到A的边权 - 连到B的边权"最大的顶点从B移入A，直到A达到目标权重；
+	增益用惰性删除的大顶堆维护，堆为空(子图不连通)时换一个随机种子. 再对A、B递归，得到[first, first+k)共k个部分.
+	调用前子集中的顶点part均为first.
+	*/
+	inline void grow_bisect(const Level& g, const std::vector<idx_t>& verts, idx_t k, idx_t first, std::vector<idx_t>& part, std::vector<int64_t>& gain, uint32_t& rng) {
+		if (k == 1 || verts.empty()) return;
+		idx_t k1 = k / 2;
+		idx_t a = first, b = first + k1;
+		int64_t total = 0;
+		for (idx_t v : verts) {
+			part[v] = b;
+			total += g.vwgt[v];
+		}
+		for (idx_t v : verts) {
+			gain[v] = 0;
+			for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+				if (part[g.adjncy[i]] == b) gain[v] -= g.weight(i);
+			}
+		}
+		int64_t target = total * k1 / k, wa = 0;
+		std::priority_queue<std::pair<int64_t, idx_t>> heap;
+		size_t seed_pos = (rng = mix(rng + 1)) % verts.size();
+		while (wa < target) {
+			if (heap.empty()) {
+				for (size_t j = 0; j < verts.size() && heap.empty(); ++j) {
+					idx_t v = verts[(seed_pos + j) % verts.size()];
+					if (part[v] == b) heap.push({ gain[v], v });
+				}
+				if (heap.empty()) break;
+			}
+			std::pair<int64_t, idx_t> top = heap.top();
+			heap.pop();
+			idx_t v = top.second;
+			if (part[v] != b || top.first != gain[v]) continue;
+			if (wa + g.vwgt[v] > target && wa + g.vwgt[v] - target > target - wa) break;
+			part[v] = a;
+			wa += g.vwgt[v];
+			for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+				idx_t u = g.adjncy[i];
+				if (part[u] != b) continue;
+				gain[u] += 2 * static_cast<int64_t>(g.weight(i));
+				heap.push({ gain[u], u });
+			}
+		}
+		std::vector<idx_t> va, vb;
+		for (idx_t v : verts) { (part[v] == a ? va : vb).push_back(v); }
+		grow_bisect(g, va, k1, a, part, gain, rng);
+		grow_bisect(g, vb, k - k1, b, part, gain, rng);
+	}
+
+	// 迁移代价：顶点不在home(原来所在的部分)时付出cost*msize，折合为割边权重；home为-1或msize为0时没有代价
+	struct Migration {
+		const idx_t* home = nullptr;
+		const idx_t* msize = nullptr;
+		double cost = 0;
+
+		double penalty(idx_t v, idx_t q) const { return home && home[v] >= 0 && q != home[v] ? cost * msize[v] : 0; }
+
+		// v的home没有出现在邻居所在的部分中时，也要作为候选，否则离开home的顶点无法回去
+		idx_t extra_candidate(idx_t v) const { return home && msize[v] > 0 ? home[v] : -1; }
+	};
+
+	/*
+	把超重部分中移出代价最小的顶点移到放得下的部分：优先连接边权最大的相邻部分，都放不下时移到最轻的部分.
+	候选按代价(割边增量与迁移代价之和)排序后依次移动，移动前重新检查，超重部分恢复正常即停止.
+	*/
+	inline void rebalance(const Level& g, idx_t k, int64_t max_pw, std::vector<idx_t>& part, const Migration& mig = Migration()) {
+		std::vector<int64_t> pw = part_weights(g, k, part);
+		std::vector<int64_t> conn(k, 0);
+		std::vector<idx_t> touched;
+		// 返回v的最佳目标部分(无则为-1)，loss为移动的代价
+		auto best_target = [&](idx_t v, double& loss) {
+			idx_t p = part[v];
+			touched.clear();
+			for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+				idx_t q = part[g.adjncy[i]];
+				if (conn[q] == 0) touched.push_back(q);
+				conn[q] += g.weight(i);
+			}
+			idx_t home = mig.extra_candidate(v);
+			if (home >= 0 && conn[home] == 0) touched.push_back(home);
+			idx_t best = -1;
+			double best_score = 0;
+			for (idx_t q : touched) {
+				double score = conn[q] - mig.penalty(v, q);
+				if (q != p && pw[q] + g.vwgt[v] <= max_pw && (best == -1 || score > best_score)) {
+					best = q;
+					best_score = score;
+				}
+			}
+			if (best == -1) {
+				idx_t lightest = static_cast<idx_t>(std::min_element(pw.begin(), pw.end()) - pw.begin());
+				if (lightest != p && pw[lightest] + g.vwgt[v] <= max_pw) {
+					best = lightest;
+					best_score = conn[lightest] - mig.penalty(v, lightest);
+				}
+			}
+			loss = conn[p] - mig.penalty(v, p) - best_score;
+			for (idx_t q : touched) { conn[q] = 0; }
+			return best;
+		};
+		for (int pass = 0; pass < 4; ++pass) {
+			std::vector<std::pair<double, idx_t>> cand;
+			for (idx_t v = 0; v < g.n; ++v) {
+				double loss;
+				if (pw[part[v]] > max_pw && best_target(v, loss) != -1) cand.push_back({ loss, v });
+			}
+			if (cand.empty()) return;
+			std::sort(cand.begin(), cand.end());
+			for (auto& c : cand) {
+				idx_t v = c.second, p = part[v];
+				double loss;
+				if (pw[p] <= max_pw) continue;
+				idx_t q = best_target(v, loss);
+				if (q == -1) continue;
+				part[v] = q;
+				pw[p] -= g.vwgt[v];
+				pw[q] += g.vwgt[v];
+			}
+		}
+	}
+
+	/*
+	并行标签传播：各顶点移到连接边权最大的相邻部分，要求割边严格减少，或割边不变而使两部分更均衡.
+	有迁移代价时比较的是连接边权减去迁移代价.
+	目标部分先用fetch_add预留权重，超过上限则撤销，保证任何时刻都不超重.
+	其他线程同时移动邻居时增益可能过时，单次移动可能使割边略增，但整体收敛，最终割边按实际结果计算.
+	一轮中移动的顶点数不足千分之一时提前结束.
+	*/
+	inline void refine(const Level& g, idx_t k, int64_t max_pw, std::vector<idx_t>& part, int rounds, ThreadPool& pool, const Migration& mig = Migration()) {
+		std::unique_ptr<std::atomic<idx_t>[]> label(new std::atomic<idx_t>[g.n]);
+		std::unique_ptr<std::atomic<int64_t>[]> pw(new std::atomic<int64_t>[k]);
+		std::vector<int64_t> init = part_weights(g, k, part);
+		for (idx_t q = 0; q < k; ++q) { pw[q].store(init[q], std::memory_order_relaxed); }
+		for (idx_t v = 0; v < g.n; ++v) { label[v].store(part[v], std::memory_order_relaxed); }
+		std::vector<std::vector<int64_t>> conns(pool.size(), std::vector<int64_t>(k, 0));
+		std::vector<std::vector<idx_t>> toucheds(pool.size());
+		for (int round = 0; round < rounds; ++round) {
+			std::atomic<size_t> moved(0);
+			for_range(pool, g.n, [&](size_t b, size_t e, int tid) {
+				std::vector<int64_t>& conn = conns[tid];
+				std::vector<idx_t>& touched = toucheds[tid];
+				size_t local = 0;
+				for (idx_t v = static_cast<idx_t>(b); v < static_cast<idx_t>(e); ++v) {
+					idx_t p = label[v].load(std::memory_order_relaxed);
+					idx_t w = g.vwgt[v];
+					touched.clear();
+					for (idx_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+						idx_t q = label[g.adjncy[i]].load(std::memory_order_relaxed);
+						if (conn[q] == 0) touched.push_back(q);
+						conn[q] += g.weight(i);
+					}
+					idx_t home = mig.extra_candidate(v);
+					if (home >= 0 && conn[home] == 0) touched.push_back(home);
+					double own = conn[p] - mig.penalty(v, p), best_score = 0;
+					int64_t pw_p = pw[p].load(std::memory_order_relaxed), best_pw = 0;
+					idx_t best = p;
+					for (idx_t q : touched) {
+						if (q == p) continue;
+						int64_t pw_q = pw[q].load(std::memory_order_relaxed);
+						double score = conn[q] - mig.penalty(v, q);
+						if (pw_q + w > max_pw || score < own || (score == own && pw_p <= pw_q + w)) continue;
+						if (best == p || score > best_score || (score == best_score && pw_q < best_pw)) {
+							best = q;
+							best_score = score;
+							best_pw = pw_q;
+						}
+					}
+					for (idx_t q : touched) { conn[q] = 0; }
+					if (best == p) continue;
+					if (pw[best].fetch_add(w, std::memory_order_relaxed) + w <= max_pw) {
+						pw[p].fetch_sub(w, std::memory_order_relaxed);
+						label[v].store(best, std::memory_order_relaxed);
+						++local;
+					}
+					else {
+						pw[best].fetch_sub(w, std::memory_order_relaxed);
+					}
+				}
+				moved.fetch_add(local, std::memory_order_relaxed);
+			});
+			if (moved.load() <= static_cast<size_t>(g.n) / 1000) break;
+		}
+		for (idx_t v = 0; v < g.n; ++v) { part[v] = label[v].load(std::memory_order_relaxed); }
+	}
+
+	/*
+	本层的部分权重上限：粗顶点较重时至少能放下平均权重再加一个最重的顶点；
+	最细一层(引用原图数组)是最终结果，只放宽到平均权重向上取整，不再为单个顶点留余量.
+	*/
+	inline int64_t level_limit(const Level& g, idx_t k, int64_t total, double imbalance) {
+		int64_t strict = std::max(static_cast<int64_t>((1 + imbalance) * total / k), (total + k - 1) / k);
+		if (g.own_xadj.empty()) return strict;
+		idx_t heaviest = g.n > 0 ? *std::max_element(g.vwgt, g.vwgt + g.n) : 0;
+		return std::max(strict, (total + k - 1) / k + heaviest);
+	}
+}
+
+
+namespace mlpart {
+	// 最细一层引用调用者的数组，多个权重维度按和合并；total返回总权重
+	inline std::unique_ptr<Level> make_finest(idx_t nvtxs, idx_t ncon, const idx_t* xadj, const idx_t* adjncy, const idx_t* vwgt, const idx_t* adjwgt, ThreadPool& pool, int64_t& total) {
+		std::unique_ptr<Level> g(new Level());
+		g->n = nvtxs;
+		g->xadj = xadj;
+		g->adjncy = adjncy;
+		g->adjwgt = adjwgt;
+		g->own_vwgt.resize(nvtxs);
+		for_range(pool, nvtxs, [&](size_t b, size_t e, int) {
+			for (size_t v = b; v < e; ++v) {
+				idx_t w = vwgt ? 0 : 1;
+				for (idx_t c = 0; vwgt && c < ncon; ++c) { w += vwgt[v * ncon + c]; }
+				g->own_vwgt[v] = w;
+			}
+		});
+		g->vwgt = g->own_vwgt.data();
+		total = 0;
+		for (idx_t w : g->own_vwgt) { total += w; }
+		return g;
+	}
+
+	/*
+	从levels.back()开始粗化，直到顶点数不超过coarsen_to*nparts或收缩率低于5%.
+	parts非空时(*parts)[0]为最细一层的已有划分：只匹配同一部分的顶点，并把划分投影到每一层；
+	msizes非空时同样把(*msizes)[0]中的迁移量逐层相加.
+	*/
+	inline void coarsen(std::vector<std::unique_ptr<Level>>& levels, idx_t k, int64_t total, const PartitionOptions& opt, ThreadPool& pool,
+		std::vector<std::vector<idx_t>>* parts = nullptr, std::vector<std::vector<idx_t>>* msizes = nullptr) {
+		const size_t stop_n = static_cast<size_t>(std::max<idx_t>(opt.coarsen_to, 1)) * k;
+		const idx_t max_vwgt = static_cast<idx_t>(std::max<int64_t>(1, 3 * total / (2 * static_cast<int64_t>(stop_n))));
+		std::vector<idx_t> match;
+		while (k > 1 && static_cast<size_t>(levels.back()->n) > stop_n) {
+			Level& g = *levels.back();
+			const idx_t* group = parts ? parts->back().data() : nullptr;
+			heavy_edge_matching(g, max_vwgt, opt.seed + static_cast<uint32_t>(levels.size()), pool, match, group);
+			std::unique_ptr<Level> c = contract(g, match, pool);
+			if (c->n > g.n * 0.95) break;
+			if (parts) {
+				std::vector<idx_t> coarse_part(c->n);
+				for (idx_t v = 0; v < g.n; ++v) { coarse_part[g.cmap[v]] = group[v]; }
+				parts->push_back(std::move(coarse_part));
+			}
+			if (msizes) {
+				std::vector<idx_t> coarse_msize(c->n, 0);
+				for (idx_t v = 0; v < g.n; ++v) { coarse_msize[g.cmap[v]] += msizes->back()[v]; }
+				msizes->push_back(std::move(coarse_msize));
+			}
+			levels.push_back(std::move(c));
+		}
+	}
+
+	/*
+	逐层投影回细图，超重时先rebalance，再做并行标签传播；part输入为最粗一层的划分，返回时为最细一层的.
+	homes、msizes非空时为coarsen投影出的各层原划分与迁移量，细化时计入迁移代价cost.
+	*/
+	inline void uncoarsen(std::vector<std::unique_ptr<Level>>& levels, idx_t k, int64_t total, const PartitionOptions& opt, ThreadPool& pool, std::vector<idx_t>& part,
+		const std::vector<std::vector<idx_t>>* homes = nullptr, const std::vector<std::vector<idx_t>>* msizes = nullptr, double cost = 0) {
+		while (levels.size() > 1) {
+			levels.pop_back(); // 释放粗图
+			Level& g = *levels.back();
+			std::vector<idx_t> fine_part(g.n);
+			for_range(pool, g.n, [&](size_t b, size_t e, int) {
+				for (size_t v = b; v < e; ++v) { fine_part[v] = part[g.cmap[v]]; }
+			});
+			part.swap(fine_part);
+			int64_t limit = level_limit(g, k, total, opt.imbalance);
+			Migration mig;
+			if (homes && msizes) {
+				mig.home = (*homes)[levels.size() - 1].data();
+				mig.msize = (*msizes)[levels.size() - 1].data();
+				mig.cost = cost;
+			}
+			rebalance(g, k, limit, part, mig);
+			refine(g, k, limit, part, opt.refine_rounds, pool, mig);
+		}
+	}
+}
+
+
+/*
+8. 多层k路划分 `multilevel_partition`，不依赖metis库
+   粗化：并行重边匹配 + 并行收缩，直到顶点数不超过coarsen_to*nparts或收缩率低于5%.
+   初始划分：在最粗的图上做递归贪心图生长二分，尝试initial_trials次，取平衡且割边最小的.
+   细化：逐层投影回细图，超重时先rebalance，再做并行标签传播.
+   多个权重维度(ncon > 1)按和合并为一个权重进行均衡，返回的balance仍按各维度分别计算.
+   数组与METIS_PartGraphKway相同：vwgt、adjwgt可为nullptr，表示权重全为1.
+*/
+inline PartitionResult multilevel_partition(idx_t nvtxs, idx_t ncon, const idx_t* xadj, const idx_t* adjncy, const idx_t* vwgt, const idx_t* adjwgt, ThreadPool& pool, const PartitionOptions& opt = PartitionOptions()) {
+	using namespace mlpart;
+	PartitionResult res;
+	idx_t k = std::max<idx_t>(opt.nparts, 1);
+	if (nvtxs == 0) return res;
+	int64_t total = 0;
+	std::vector<std::unique_ptr<Level>> levels;
+	levels.push_back(make_finest(nvtxs, ncon, xadj, adjncy, vwgt, adjwgt, pool, total));
+	coarsen(levels, k, total, opt, pool);
+	res.levels = static_cast<int>(levels.size()) - 1;
+
+	// 初始划分
+	Level& coarsest = *levels.back();
+	int64_t limit = level_limit(coarsest, k, total, opt.imbalance);
+	std::vector<idx_t> part, trial(coarsest.n);
+	std::vector<idx_t> all(coarsest.n);
+	std::vector<int64_t> gain(coarsest.n);
+	for (idx_t v = 0; v < coarsest.n; ++v) { all[v] = v; }
+	std::pair<bool, int64_t> best(true, 0); // (是否超重, 割边)
+	for (int t = 0; t < std::max(opt.initial_trials, 1); ++t) {
+		uint32_t rng = mix(opt.seed * 7919 + t);
+		std::fill(trial.begin(), trial.end(), 0);
+		grow_bisect(coarsest, all, k, 0, trial, gain, rng);
+		rebalance(coarsest, k, limit, trial);
+		refine(coarsest, k, limit, trial, opt.refine_rounds, pool);
+		std::vector<int64_t> pw = part_weights(coarsest, k, trial);
+		std::pair<bool, int64_t> score(*std::max_element(pw.begin(), pw.end()) > limit, level_cut(coarsest, trial));
+		if (part.empty() || score < best) {
+			best = score;
+			part = trial;
+		}
+	}
+
+	uncoarsen(levels, k, total, opt, pool, part);
+	res.part = std::move(part);
+	res.edge_cut = edge_cut(nvtxs, xadj, adjncy, adjwgt, res.part.data());
+	res.balance = partition_balance(nvtxs, ncon, vwgt, k, res.part.data());
+	return res;
+}
+
+/*
+以已有划分(如流式划分的结果)为起点做一次多层细化(V-cycle)：粗化时只合并同一部分中的顶点，
+最粗一层直接沿用已有划分，跳过初始划分，再逐层投影细化. 结果不会比起点差太多，通常比从头划分快.
+part大小须为nvtxs，部分编号须在[0, opt.nparts)内，否则返回false，error给出原因.
+*/
+inline bool multilevel_refine(idx_t nvtxs, idx_t ncon, const idx_t* xadj, const idx_t* adjncy, const idx_t* vwgt, const idx_t* adjwgt, const std::vector<idx_t>& part,
+	PartitionResult& res, ThreadPool& pool, const PartitionOptions& opt = PartitionOptions(), std::string* error = nullptr) {
+	using namespace mlpart;
+	res = PartitionResult();
+	idx_t k = std::max<idx_t>(opt.nparts, 1);
+	if (part.size() != static_cast<size_t>(nvtxs)) {
+		if (error) *error = "partition does not match graph";
+		return false;
+	}
+	if (!valid_partition(nvtxs, k, part.data())) {
+		if (error) *error = "part id out of range";
+		return false;
+	}
+	if (nvtxs == 0) return true;
+	int64_t total = 0;
+	std::vector<std::unique_ptr<Level>> levels;
+	levels.push_back(make_finest(nvtxs, ncon, xadj, adjncy, vwgt, adjwgt, pool, total));
+	std::vector<std::vector<idx_t>> parts(1, part);
+	coarsen(levels, k, total, opt, pool, &parts);
+	res.levels = static_cast<int>(levels.size()) - 1;
+
+	Level& coarsest = *levels.back();
+	std::vector<idx_t> coarse_part = std::move(parts.back());
+	parts.clear();
+	int64_t limit = level_limit(coarsest, k, total, opt.imbalance);
+	rebalance(coarsest, k, limit, coarse_part);
+	refine(coarsest, k, limit, coarse_part, opt.refine_rounds, pool);
+
+	uncoarsen(levels, k, total, opt, pool, coarse_part);
+	res.part = std::move(coarse_part);
+	res.edge_cut = edge_cut(nvtxs, xadj, adjncy, adjwgt, res.part.data());
+	res.balance = partition_balance(nvtxs, ncon, vwgt, k, res.part.data());
+	return true;
+}
+
+/*
+参数与METIS_PartGraphKway/METIS_PartGraphRecursive相同，可以直接传给main.cpp中的func()，不需要链接metis库.
+ubvec[0]为允许的不均衡度(如1.03)，为nullptr时取1.03；tpwgts、vsize、options忽略. 使用全部硬件线程.
+*/
+inline int part_graph_kway(idx_t* nvtxs, idx_t* ncon, idx_t* xadj, idx_t* adjncy, idx_t* vwgt, idx_t* vsize, idx_t* adjwgt,
+	idx_t* nparts, real_t* tpwgts, real_t* ubvec, idx_t* options, idx_t* edgecut, idx_t* part) {
+	(void)vsize;
+	(void)tpwgts;
+	(void)options;
+	if (!nvtxs || !xadj || !adjncy || !nparts || !part || *nvtxs < 0 || *nparts < 1 || (ncon && *ncon < 1)) return METIS_ERROR_INPUT;
+	PartitionOptions opt;
+	opt.nparts = *nparts;
+	if (ubvec) opt.imbalance = std::max(0.0, static_cast<double>(ubvec[0]) - 1);
+	ThreadPool pool(std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+	PartitionResult res = multilevel_partition(*nvtxs, ncon ? *ncon : 1, xadj, adjncy, vwgt, adjwgt, pool, opt);
+	std::copy(res.part.begin(), res.part.end(), part);
+	if (edgecut) *edgecut = static_cast<idx_t>(res.edge_cut);
+	return METIS_OK;
+}
+
+#endif // MYCPPPITFALLS_PARTITIONER_HPP
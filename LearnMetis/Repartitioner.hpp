@@ -0,0 +1,228 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_REPARTITIONER_HPP
+#define MYCPPPITFALLS_REPARTITIONER_HPP
+
+#include <unordered_set>
+#include <unordered_map>
+#include <utility>
+#include "MetisLoader.hpp"
+#include "Partitioner.hpp"
+
+
+/*
+图的一次变化. 编号：[0, nvtxs)为原有顶点，[nvtxs, nvtxs + added_vertices)为新增顶点.
+先删除再添加；删除顶点时同时删除它的所有边，添加已存在的边相当于修改边权.
+*/
+struct GraphDelta {
+	idx_t added_vertices = 0;
+	std::vector<idx_t> added_vwgt;  // added_vertices*ncon，为空时权重为1
+	std::vector<idx_t> added_vsize; // 为空时为1
+	std::vector<idx_t> removed_vertices;
+	std::vector<std::pair<idx_t, idx_t>> added_edges;   // 无向边
+	std::vector<idx_t> added_adjwgt;                    // 与added_edges一一对应，为空时为1
+	std::vector<std::pair<idx_t, idx_t>> removed_edges;
+};
+
+struct RepartitionOptions : PartitionOptions {
+	double migration_cost = 1; // 迁移一个单位vsize折合的割边权重，越大越倾向于不动
+};
+
+struct RepartitionResult : PartitionResult {
+	int64_t migration = 0; // 离开原部分的顶点的vsize之和，没有vsize时为顶点数
+	idx_t moved = 0;       // 离开原部分的顶点数
+};
+
+
+/*
+把delta应用到g上得到updated，其余顶点保持原来的相对顺序紧凑编号；new_id[i]为扩展编号i的新编号，被删除的顶点为-1.
+原图与delta都没有某种权重时，结果也没有. 编号越界、自环、边连到被删除的顶点时返回false.
+*/
+inline bool apply_delta(const MetisGraph& g, const GraphDelta& d, MetisGraph& updated, std::vector<idx_t>& new_id, std::string* error = nullptr) {
+	auto fail = [&](const std::string& msg) {
+		if (error) *error = msg;
+		return false;
+	};
+	const idx_t total = g.nvtxs + d.added_vertices;
+	if (d.added_vertices < 0 || (!d.added_vwgt.empty() && d.added_vwgt.size() != static_cast<size_t>(d.added_vertices) * g.ncon)
+		|| (!d.added_vsize.empty() && d.added_vsize.size() != static_cast<size_t>(d.added_vertices))
+		|| (!d.added_adjwgt.empty() && d.added_adjwgt.size() != d.added_edges.size())) return fail("delta array sizes do not match");
+	std::vector<char> dead(total, 0);
+	for (idx_t v : d.removed_vertices) {
+		if (v < 0 || v >= total) return fail("removed vertex out of range");
+		dead[v] = 1;
+	}
+	new_id.assign(total, -1);
+	idx_t n = 0;
+	for (idx_t i = 0; i < total; ++i) {
+		if (!dead[i]) new_id[i] = n++;
+	}
+
+	auto key = [](idx_t u, idx_t v) { return static_cast<uint64_t>(std::min(u, v)) << 32 | static_cast<uint32_t>(std::max(u, v)); };
+	std::unordered_set<uint64_t> removed;
+	for (auto& e : d.removed_edges) {
+		if (e.first < 0 || e.first >= total || e.second < 0 || e.second >= total) return fail("removed edge out of range");
+		removed.insert(key(e.first, e.second));
+	}
+	std::unordered_map<idx_t, std::vector<std::pair<idx_t, idx_t>>> extra; // 顶点 → 新增的(邻居, 边权)
+	auto add_half = [&](idx_t u, idx_t v, idx_t w) {
+		std::vector<std::pair<idx_t, idx_t>>& list = extra[u];
+		for (auto& x : list) {
+			if (x.first == v) {
+				x.second = w;
+				return;
+			}
+		}
+		list.push_back({ v, w });
+	};
+	for (size_t j = 0; j < d.added_edges.size(); ++j) {
+		idx_t u = d.added_edges[j].first, v = d.added_edges[j].second;
+		if (u < 0 || u >= total || v < 0 || v >= total || u == v) return fail("added edge out of range or self loop");
+		if (dead[u] || dead[v]) return fail("added edge touches a removed vertex");
+		idx_t w = d.added_adjwgt.empty() ? 1 : d.added_adjwgt[j];
+		add_half(u, v, w);
+		add_half(v, u, w);
+	}
+
+	const bool has_ewgt = !g.adjwgt.empty() || !d.added_adjwgt.empty();
+	const bool has_vwgt = !g.vwgt.empty() || !d.added_vwgt.empty();
+	const bool has_vsize = !g.vsize.empty() || !d.added_vsize.empty();
+	updated = MetisGraph();
+	updated.nvtxs = n;
+	updated.ncon = g.ncon;
+	updated.fmt = (has_ewgt ? EDGE_WEIGHT : 0) | (has_vwgt ? VERTEX_WEIGHT : 0) | (has_vsize ? VERTEX_SIZE : 0);
+	updated.xadj.reserve(static_cast<size_t>(n) + 1);
+	updated.adjncy.reserve(g.adjncy.size() + 2 * d.added_edges.size());
+	for (idx_t i = 0; i < total; ++i) {
+		if (dead[i]) continue;
+		updated.xadj.push_back(static_cast<idx_t>(updated.adjncy.size()));
+		auto iter = extra.find(i);
+		const std::vector<std::pair<idx_t, idx_t>>* added = iter == extra.end() ? nullptr : &iter->second;
+		if (i < g.nvtxs) {
+			for (idx_t j = g.xadj[i]; j < g.xadj[i + 1]; ++j) {
+				idx_t u = g.adjncy[j];
+				if (dead[u] || removed.count(key(i, u))) continue;
+				if (added && std::any_of(added->begin(), added->end(), [u](const std::pair<idx_t, idx_t>& x) { return x.first == u; })) continue; // 边权被修改
+				updated.adjncy.push_back(new_id[u]);
+				if (has_ewgt) updated.adjwgt.push_back(g.adjwgt.empty() ? 1 : g.adjwgt[j]);
+			}
+		}
+		for (size_t j = 0; added && j < added->size(); ++j) {
+			updated.adjncy.push_back(new_id[(*added)[j].first]);
+			if (has_ewgt) updated.adjwgt.push_back((*added)[j].second);
+		}
+		size_t a = static_cast<size_t>(i - g.nvtxs); // 新增顶点在delta数组中的下标
+		for (idx_t c = 0; has_vwgt && c < g.ncon; ++c) {
+			updated.vwgt.push_back(i < g.nvtxs ? (g.vwgt.empty() ? 1 : g.vwgt[static_cast<size_t>(i) * g.ncon + c]) : (d.added_vwgt.empty() ? 1 : d.added_vwgt[a * g.ncon + c]));
+		}
+		if (has_vsize) updated.vsize.push_back(i < g.nvtxs ? (g.vsize.empty() ? 1 : g.vsize[i]) : (d.added_vsize.empty() ? 1 : d.added_vsize[a]));
+	}
+	updated.xadj.push_back(static_cast<idx_t>(updated.adjncy.size()));
+	updated.nedges = static_cast<idx_t>(updated.adjncy.size() / 2);
+	return true;
+}
+
+// 把原划分投影到新编号上，新增顶点为-1
+inline std::vector<idx_t> project_partition(const std::vector<idx_t>& prev, const std::vector<idx_t>& new_id, idx_t nvtxs) {
+	std::vector<idx_t> home(nvtxs, -1);
+	for (size_t i = 0; i < prev.size() && i < new_id.size(); ++i) {
+		if (new_id[i] >= 0) home[new_id[i]] = prev[i];
+	}
+	return home;
+}
+
+
+/*
+9. 增量重划分 `repartition`
+   图只有少量变化时以原划分为起点修正，而不是从头划分：从头划分即使割边相近，边界也会整体变化，大量顶点需要迁移.
+   1. 新顶点放到已放置的邻居中连接边权最大的部分，没有邻居时放到最轻的部分.
+   2. 粗化时只合并同一部分的顶点，迁移量(vsize，没有时为1)逐层相加，最粗一层直接沿用原划分.
+   3. 逐层细化的目标为 割边 + migration_cost × 迁移量：离开原部分要付出迁移代价，回到原部分则收回；
+      超重时rebalance优先移动总代价最小的顶点，都是局部修正.
+   migration_cost为0时只看割边(仍从原划分出发)，越大越接近只做恢复均衡所必需的移动.
+   home[v]为v原来所在的部分，-1或不小于nparts(部分数减少)的视为新顶点，不计迁移.
+*/
+inline RepartitionResult repartition(idx_t nvtxs, idx_t ncon, const idx_t* xadj, const idx_t* adjncy, const idx_t* vwgt, const idx_t* vsize, const idx_t* adjwgt,
+	const std::vector<idx_t>& home, ThreadPool& pool, const RepartitionOptions& opt = RepartitionOptions()) {
+	using namespace mlpart;
+	RepartitionResult res;
+	const idx_t k = std::max<idx_t>(opt.nparts, 1);
+	if (nvtxs == 0) return res;
+	int64_t total = 0;
+	std::vector<std::unique_ptr<Level>> levels;
+	levels.push_back(make_finest(nvtxs, ncon, xadj, adjncy, vwgt, adjwgt, pool, total));
+	const Level& finest = *levels[0];
+
+	// 原划分与迁移量，放置新顶点
+	std::vector<idx_t> seed(nvtxs), msize(nvtxs);
+	std::vector<int64_t> pw(k, 0), conn(k, 0);
+	for (idx_t v = 0; v < nvtxs; ++v) {
+		bool old = home[v] >= 0 && home[v] < k;
+		seed[v] = old ? home[v] : -1;
+		msize[v] = old ? (vsize ? vsize[v] : 1) : 0;
+		if (old) pw[seed[v]] += finest.vwgt[v];
+	}
+	std::vector<idx_t> touched;
+	for (idx_t v = 0; v < nvtxs; ++v) {
+		if (seed[v] >= 0) continue;
+		touched.clear();
+		for (idx_t i = xadj[v]; i < xadj[v + 1]; ++i) {
+			idx_t q = seed[adjncy[i]];
+			if (q < 0) continue;
+			if (conn[q] == 0) touched.push_back(q);
+			conn[q] += adjwgt ? adjwgt[i] : 1;
+		}
+		idx_t best = static_cast<idx_t>(std::min_element(pw.begin(), pw.end()) - pw.begin());
+		for (idx_t q : touched) {
+			if (conn[q] > conn[best] || (conn[q] == conn[best] && pw[q] < pw[best])) best = q;
+		}
+		for (idx_t q : touched) { conn[q] = 0; }
+		seed[v] = best;
+		pw[best] += finest.vwgt[v];
+	}
+
+	std::vector<std::vector<idx_t>> parts(1, seed), msizes(1, msize);
+	coarsen(levels, k, total, opt, pool, &parts, &msizes);
+	res.levels = static_cast<int>(levels.size()) - 1;
+	Level& coarsest = *levels.back();
+	std::vector<idx_t> part = parts.back();
+	Migration mig;
+	mig.home = parts.back().data();
+	mig.msize = msizes.back().data();
+	mig.cost = opt.migration_cost;
+	int64_t limit = level_limit(coarsest, k, total, opt.imbalance);
+	rebalance(coarsest, k, limit, part, mig);
+	refine(coarsest, k, limit, part, opt.refine_rounds, pool, mig);
+	uncoarsen(levels, k, total, opt, pool, part, &parts, &msizes, opt.migration_cost);
+
+	res.part = std::move(part);
+	res.edge_cut = edge_cut(nvtxs, xadj, adjncy, adjwgt, res.part.data());
+	res.balance = partition_balance(nvtxs, ncon, vwgt, k, res.part.data());
+	for (idx_t v = 0; v < nvtxs; ++v) {
+		if (home[v] >= 0 && home[v] < k && res.part[v] != home[v]) {
+			res.migration += msize[v];
+			++res.moved;
+		}
+	}
+	return res;
+}
+
+// 应用delta后重划分；prev为原图上的划分，updated返回新图，res.part按新图编号
+inline bool repartition(const MetisGraph& g, const std::vector<idx_t>& prev, const GraphDelta& d, MetisGraph& updated, RepartitionResult& res,
+	ThreadPool& pool, const RepartitionOptions& opt = RepartitionOptions(), std::string* error = nullptr) {
+	if (prev.size() != static_cast<size_t>(g.nvtxs)) {
+		if (error) *error = "previous partition does not match graph";
+		return false;
+	}
+	std::vector<idx_t> new_id;
+	if (!apply_delta(g, d, updated, new_id, error)) return false;
+	res = repartition(updated.nvtxs, updated.ncon, updated.xadj.data(), updated.adjncy.data(), updated.vwgt.empty() ? nullptr : updated.vwgt.data(),
+		updated.vsize.empty() ? nullptr : updated.vsize.data(), updated.adjwgt.empty() ? nullptr : updated.adjwgt.data(),
+		project_partition(prev, new_id, updated.nvtxs), pool, opt);
+	return true;
+}
+
+#endif // MYCPPPITFALLS_REPARTITIONER_HPP
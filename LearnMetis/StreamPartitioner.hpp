@@ -0,0 +1,160 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_STREAMPARTITIONER_HPP
+#define MYCPPPITFALLS_STREAMPARTITIONER_HPP
+
+#include <cmath>
+#include <queue>
+#include <functional>
+#include "MetisCsrFile.hpp"
+#include "Partitioner.hpp"
+
+
+enum StreamScore {
+	LDG,   // 邻居数 × (1 - 部分权重/容量)
+	FENNEL // 邻居数 - α·γ·部分权重^(γ-1)的离散形式
+};
+
+struct StreamPartitionOptions {
+	idx_t nparts = 2;
+	double imbalance = 0.03;  // 容量为(1+imbalance)*总权重/nparts，不超过容量是硬约束
+	StreamScore score = LDG;  // 按行顺序编号的网格上LDG割边更小，无结构的随机图上两者相当
+	double gamma = 1.5;       // Fennel的指数，1.5为论文中的推荐值
+	size_t buffer_bytes = 1 << 20; // 读缓冲大小
+};
+
+/*
+单遍流式划分：按METIS文件的顺序读入每个顶点的邻接行，读完一行立即决定该顶点所属的部分，不建立CSR.
+   只有已分配的邻居参与打分(编号更大的邻居还没读到)，候选为这些邻居所在的部分加上当前最轻的部分.
+   LDG：score(q) = conn(q) * (1 - w(q)/C).
+   Fennel：score(q) = conn(q) - α((w(q)+w)^γ - w(q)^γ)，α = m·k^(γ-1)/n^γ.
+   C为容量，超过容量的部分不参与；都放不下时放到最轻的部分. 最轻的部分用惰性删除的小顶堆维护，每个顶点O(度数 + log k).
+   顶点有权重时总权重事先未知，按已读部分的平均权重估计；边有权重时m按已读的平均边权放大.
+   内存只有part数组、k个部分的权重和读缓冲，与边数无关.
+   每条边在后读到的一端计入割边，结果中的edge_cut是精确值；balance按合并后的顶点权重计算.
+   数字由metis_csr::Reader解析，规则与load_metis相同：超出idx_t范围的数、编号越界、数字个数与fmt不符时返回false.
+   结果可直接save_partition，也可作为multilevel_refine的起点.
+*/
+inline bool stream_partition(const std::string& graph_path, PartitionResult& res, const StreamPartitionOptions& opt = StreamPartitionOptions(), std::string* error = nullptr) {
+	using namespace metis_csr;
+	auto fail = [&](const std::string& msg) {
+		if (error) *error = msg;
+		return false;
+	};
+	Reader in(graph_path, opt.buffer_bytes);
+	if (!in.good()) return fail("cannot open " + graph_path);
+	idx_t n = 0, m = 0, ncon = 1;
+	int fmt = 0;
+	if (!read_header(in, n, m, fmt, ncon)) return fail("bad header");
+	const bool has_vsize = (fmt & VERTEX_SIZE) != 0;
+	const bool has_vwgt = (fmt & VERTEX_WEIGHT) != 0;
+	const bool has_ewgt = (fmt & EDGE_WEIGHT) != 0;
+	const uint64_t prefix = (has_vsize ? 1 : 0) + (has_vwgt ? ncon : 0);
+	const uint64_t stride = has_ewgt ? 2 : 1;
+	const idx_t k = std::max<idx_t>(opt.nparts, 1);
+
+	res = PartitionResult();
+	res.part.assign(n, -1);
+	std::vector<int64_t> pw(k, 0), conn(k, 0);
+	std::vector<idx_t> touched;
+	typedef std::pair<int64_t, idx_t> Load; // (部分权重, 部分)
+	std::priority_queue<Load, std::vector<Load>, std::greater<Load>> lightest;
+	for (idx_t q = 0; q < k; ++q) { lightest.push({ 0, q }); }
+	auto lightest_part = [&]() {
+		while (lightest.top().first != pw[lightest.top().second]) { lightest.pop(); }
+		return lightest.top().second;
+	};
+
+	bool bad = false;
+	idx_t v = 0;
+	uint64_t e = 0;
+	int64_t seen_w = 0, seen_ew = 0;
+	while (v < n && !in.eof() && !bad) {
+		if (in.rest_is_comment()) {
+			in.skip_line();
+			continue;
+		}
+		idx_t x = 0, u = 0;
+		int64_t w = 0, assigned = 0; // assigned为连到已分配邻居的边权和
+		uint64_t tokens = 0;
+		for (; in.next_int(x, bad); ++tokens) {
+			if (tokens < prefix) {
+				if (!(has_vsize && tokens == 0)) w += x;
+				continue;
+			}
+			if ((tokens - prefix) % stride == 0) {
+				if (x < 1 || x > n || e == 2 * static_cast<uint64_t>(m)) {
+					bad = true;
+					break;
+				}
+				u = x - 1;
+				++e;
+				if (has_ewgt) continue; // 边权是下一个数
+				x = 1;
+			}
+			seen_ew += x; // x为到u的边权
+			idx_t q = res.part[u];
+			if (q >= 0) {
+				if (conn[q] == 0) touched.push_back(q);
+				conn[q] += x;
+				assigned += x;
+			}
+		}
+		if (tokens != 0 && (tokens < prefix || (tokens - prefix) % stride != 0)) bad = true;
+		if (bad) break;
+		if (!has_vwgt) w = 1;
+		else if (tokens == 0) w = ncon; // 空行：属性取默认值
+		seen_w += w;
+
+		// 按已读部分估计总权重与总边权
+		double est_w = std::max(static_cast<double>(seen_w), static_cast<double>(seen_w) / (v + 1) * n);
+		double capacity = (1 + opt.imbalance) * est_w / k; // 只有最轻的部分也放不下时才超出
+		double est_m = e == 0 ? m : static_cast<double>(m) * seen_ew / e;
+		double alpha = est_m * std::pow(static_cast<double>(k), opt.gamma - 1) / std::pow(est_w, opt.gamma);
+		idx_t light = lightest_part();
+		if (conn[light] == 0) touched.push_back(light); // 没有已分配邻居的部分中，最轻的得分最高
+		idx_t best = -1;
+		double best_score = 0;
+		for (idx_t q : touched) {
+			if (pw[q] + w > capacity) continue;
+			double score = opt.score == LDG
+				? conn[q] * (1 - pw[q] / capacity)
+				: conn[q] - alpha * (std::pow(static_cast<double>(pw[q] + w), opt.gamma) - std::pow(static_cast<double>(pw[q]), opt.gamma));
+			if (best == -1 || score > best_score || (score == best_score && pw[q] < pw[best])) {
+				best = q;
+				best_score = score;
+			}
+		}
+		if (best == -1) best = light;
+		res.edge_cut += assigned - conn[best];
+		for (idx_t q : touched) { conn[q] = 0; }
+		touched.clear();
+		res.part[v] = best;
+		pw[best] += w;
+		lightest.push({ pw[best], best });
+		in.skip_line();
+		++v;
+	}
+	while (!bad && !in.eof()) { // 多余的行只允许是空行或注释
+		idx_t x = 0;
+		if (!in.rest_is_comment() && in.next_int(x, bad)) bad = true;
+		in.skip_line();
+	}
+	for (; v < n && !bad; ++v) { // 缺少的末尾行视为没有邻居的顶点
+		int64_t w = has_vwgt ? ncon : 1;
+		seen_w += w;
+		idx_t light = lightest_part();
+		res.part[v] = light;
+		pw[light] += w;
+		lightest.push({ pw[light], light });
+	}
+	if (bad) return fail("bad number, token count or neighbour id");
+	if (e != 2 * static_cast<uint64_t>(m)) return fail("edge count does not match header");
+	res.balance = seen_w > 0 ? static_cast<double>(*std::max_element(pw.begin(), pw.end())) * k / seen_w : 0;
+	return true;
+}
+
+#endif // MYCPPPITFALLS_STREAMPARTITIONER_HPP
@@ -3,15 +3,20 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <sstream>
+#include <thread>
+#include "MetisCsrFile.hpp"
+#include "Repartitioner.hpp"
+#include "StreamPartitioner.hpp"
 
 using namespace std;
 
+const idx_t kParts = 2; // 子图个数≥2，与参考划分partition_c.txt相同
+
 vector<idx_t> func(vector<idx_t>& xadj, vector<idx_t>& adjncy, vector<idx_t>& vwgt, vector<idx_t>& adjwgt, decltype(METIS_PartGraphKway)* METIS_PartGraphFunc) {
 	idx_t nVertices = xadj.size() - 1; // 节点数
 	idx_t nEdges = adjncy.size() / 2;  // 边数
 	idx_t nWeights = 1;                // 节点权重维数
-	idx_t nParts = 2;                  // 子图个数≥2
+	idx_t nParts = kParts;             // 子图个数
 	idx_t objval;                      // 目标函数值
 	vector<idx_t> part(nVertices, 0);  // 划分结果
 
@@ -33,49 +38,83 @@ vector<idx_t> func(vector<idx_t>& xadj, vector<idx_t>& adjncy, vector<idx_t>& vw
 	return part;
 }
 
-enum FmtBit {
-	EDGE_WEIGHT = 0x0001,
-	VERTEX_WEIGHT = 0x0002,
-	VERTEX_SIZE = 0x0004
-};
-
-
 int main() {
-	ifstream ingraph("graph_c.txt");
-	if (!ingraph) {
-		cout << "打开文件失败！" << endl;
+	MetisGraph graph; // 内存映射 + 多线程解析，xadj/adjncy/vwgt/adjwgt按头部一次分配
+	string error;
+	if (!load_metis("graph_c.txt", graph, static_cast<int>(thread::hardware_concurrency()), &error)) {
+		cout << "读取图失败: " << error << endl;
 		exit(1);
 	}
-	int vexnum, edgenum, fmt;
-	string line;
-	getline(ingraph, line);
-	istringstream tmp(line);
-	tmp >> vexnum >> edgenum >> fmt;
-	vector<idx_t> xadj(0);
-	vector<idx_t> adjncy(0); // 压缩图表示
-	vector<idx_t> vwgt(0);   // 节点权重
-	vector<idx_t> adjwgt(0); // 边权重
 
-	idx_t v, a, w;
-	for (int i = 0; i < vexnum; i++) {
-		xadj.push_back(adjncy.size());
-		getline(ingraph, line);
-		istringstream tmp(line);
-		if (fmt & FmtBit::VERTEX_WEIGHT && tmp >> v) {
-			vwgt.push_back(v);
+	// 比内存大的图：限定缓冲区流式转为磁盘CSR，再映射打开
+	MetisCsrFile csr;
+	if (stream_metis_csr("graph_c.txt", "graph_c.csr", 1 << 20, &error) && csr.open("graph_c.csr")) {
+		cout << "CSR文件: " << csr.nvtxs() << " 个顶点, " << csr.nedges() << " 条边" << endl;
+	}
+
+	// 边读边划分，不建立CSR；结果再作为多层细化的起点
+	PartitionResult streamed, refined;
+	StreamPartitionOptions sopt;
+	sopt.nparts = kParts;
+	PartitionOptions popt;
+	popt.nparts = kParts;
+	if (stream_partition("graph_c.txt", streamed, sopt, &error) && save_partition("partition_c_stream.txt", streamed.part)) {
+		ThreadPool pool(static_cast<int>(thread::hardware_concurrency()));
+		if (multilevel_refine(graph.nvtxs, graph.ncon, graph.xadj.data(), graph.adjncy.data(), graph.vwgt.empty() ? NULL : graph.vwgt.data(),
+			graph.adjwgt.empty() ? NULL : graph.adjwgt.data(), streamed.part, refined, pool, popt, &error)) {
+			cout << "流式划分 割边: " << streamed.edge_cut << ", 均衡度: " << streamed.balance
+				<< ", 细化后 割边: " << refined.edge_cut << ", 均衡度: " << refined.balance << endl;
 		}
-		while (tmp >> a >> w) {
-			adjncy.push_back(a - 1); // 节点id从0开始
-			adjwgt.push_back(w);
+		else {
+			cout << "细化失败: " << error << endl;
 		}
 	}
-	xadj.push_back(adjncy.size());
-	ingraph.close();
 
-	vector<idx_t> part = func(xadj, adjncy, vwgt, adjwgt, METIS_PartGraphRecursive);
-	//vector<idx_t> part = func(xadj, adjncy, vwgt, adjwgt, METIS_PartGraphKway);
+	// 与METIS的参考划分比较割边和均衡度，部分编号超出kParts的文件直接拒绝
+	vector<idx_t> previous;
+	if (!load_partition("partition_c.txt", kParts, previous, &error)) {
+		cout << "读取参考划分失败: " << error << endl;
+	}
+	else if (previous.size() == graph.xadj.size() - 1) {
+		cout << "参考划分 割边: " << edge_cut(graph.nvtxs, graph.xadj.data(), graph.adjncy.data(), graph.adjwgt.empty() ? NULL : graph.adjwgt.data(), previous.data())
+			<< ", 均衡度: " << partition_balance(graph.nvtxs, graph.ncon, graph.vwgt.empty() ? NULL : graph.vwgt.data(), kParts, previous.data()) << endl;
+	}
+
+#ifdef _MSC_VER // 预编译的metis库只有Windows版本
+	vector<idx_t> part = func(graph.xadj, graph.adjncy, graph.vwgt, graph.adjwgt, METIS_PartGraphRecursive);
+	//vector<idx_t> part = func(graph.xadj, graph.adjncy, graph.vwgt, graph.adjwgt, METIS_PartGraphKway);
+#else
+	vector<idx_t> part = func(graph.xadj, graph.adjncy, graph.vwgt, graph.adjwgt, part_graph_kway); // 内置的并行多层划分，不依赖metis库
+#endif
+	cout << "本次划分 均衡度: " << partition_balance(graph.nvtxs, graph.ncon, graph.vwgt.empty() ? NULL : graph.vwgt.data(), kParts, part.data()) << endl;
+
+	// 图有少量变化时，从上面的划分出发增量修正，迁移代价越大移动的顶点越少
+	// 两个新顶点都连到顶点3(编号2)，放入它所在的部分后该部分超重，必须移出一些顶点：
+	// 迁移代价为0时移动割边最小的一组，为10时只做恢复均衡所必需的移动，割边更大
+	GraphDelta delta;
+	delta.added_vertices = 2;                       // 新顶点编号为7、8
+	delta.added_vwgt = { 4, 1 };
+	delta.added_edges = { { 7, 2 }, { 8, 2 } };
+	delta.added_adjwgt = { 2, 4 };
+	ThreadPool pool(static_cast<int>(thread::hardware_concurrency()));
+	for (double cost : { 0.0, 10.0 }) {
+		RepartitionOptions ropt;
+		ropt.nparts = kParts;
+		ropt.migration_cost = cost;
+		MetisGraph updated;
+		RepartitionResult changed;
+		if (repartition(graph, part, delta, updated, changed, pool, ropt, &error)) {
+			cout << "增量重划分(迁移代价" << cost << ") 割边: " << changed.edge_cut << ", 迁移量: " << changed.migration
+				<< ", 均衡度: " << changed.balance << endl;
+		}
+	}
 
-	ofstream outpartition("partition_c.txt");
+#ifdef _MSC_VER
+	const char* out_path = "partition_c.txt";         // METIS的结果，即参考划分
+#else
+	const char* out_path = "partition_c_intree.txt";  // 内置划分器的结果另存，不覆盖参考划分
+#endif
+	ofstream outpartition(out_path);
 	if (!outpartition) {
 		cout << "打开文件失败！" << endl;
 		exit(1);
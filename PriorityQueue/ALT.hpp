@@ -0,0 +1,173 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_ALT_HPP
+#define MYCPPPITFALLS_ALT_HPP
+
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <random>
+#include "ShortestPath.hpp"
+
+
+/*
+ALT(A*, Landmarks, Triangle inequality)目标导向搜索
+   预处理：选k个地标L，记录 d(L,v) 与 d(v,L)；
+   由三角不等式，d(v,t) >= d(L,t) - d(L,v) 且 d(v,t) >= d(v,L) - d(t,L)，
+   取所有地标的最大值作为A*的启发函数h(v)，该下界是一致的(consistent)，
+   因此每个顶点仍然只需出队一次，队列按 f = g + h 排序.
+   地标用`最远点`策略选取：每次取距已选地标最远的可达顶点，使地标分布在图的边缘；
+   已选地标可达的顶点都已是地标时(如其余顶点都是孤立点)，随机取一个非地标顶点.
+   预处理结果可以save()保存，load()时按顶点数、边数与CSR校验和确认是同一张图.
+*/
+class ALT {
+public:
+	ALT() : v_num(0), k(0), e_num(0), graph_checksum(0) {}
+
+	void preprocess(const Graph& g, int landmark_num) {
+		v_num = g.vertex_num();
+		k = std::max(0, std::min(landmark_num, v_num));
+		landmark.clear();
+		fwd.assign(static_cast<size_t>(v_num) * k, INF);
+		bwd.assign(static_cast<size_t>(v_num) * k, INF);
+		vector<int> nearest(v_num, INF); // 与已选地标之间的最小距离(任一方向)，INF表示与所有地标都不连通
+		std::mt19937 rng(static_cast<unsigned>(v_num));
+		int next = 0;
+		for (int i = 0; i < k; ++i) {
+			landmark.push_back(next);
+			vector<int> df = single_source_dist(g.adjacency(), next);
+			vector<int> db = single_source_dist(g.reverse_adjacency(), next);
+			for (int v = 0; v < v_num; ++v) {
+				fwd[static_cast<size_t>(v) * k + i] = df[v];
+				bwd[static_cast<size_t>(v) * k + i] = db[v];
+				nearest[v] = std::min(nearest[v], std::min(df[v], db[v]));
+			}
+			// 下一个地标：已选地标可达的顶点中离地标最远的一个
+			next = -1;
+			for (int v = 0; v < v_num; ++v) {
+				if (nearest[v] > 0 && nearest[v] < INF && (next == -1 || nearest[v] > nearest[next])) next = v;
+			}
+			if (next == -1 && i + 1 < k) {
+				vector<int> rest;
+				for (int v = 0; v < v_num; ++v) {
+					if (std::find(landmark.begin(), landmark.end(), v) == landmark.end()) rest.push_back(v);
+				}
+				next = rest[rng() % rest.size()];
+			}
+		}
+		e_num = g.edge_num();
+		graph_checksum = g.checksum();
+	}
+
+	// v到t距离的下界，无可用地标时为0
+	int lower_bound(int v, int t) const {
+		int h = 0;
+		const int* fv = fwd.data() + static_cast<size_t>(v) * k;
+		const int* ft = fwd.data() + static_cast<size_t>(t) * k;
+		const int* bv = bwd.data() + static_cast<size_t>(v) * k;
+		const int* bt = bwd.data() + static_cast<size_t>(t) * k;
+		for (int i = 0; i < k; ++i) {
+			if (ft[i] < INF && fv[i] < INF) h = std::max(h, ft[i] - fv[i]);
+			if (bv[i] < INF && bt[i] < INF) h = std::max(h, bv[i] - bt[i]);
+		}
+		return h;
+	}
+
+	// A*点对点查询，返回最短距离(不可达为INF)，路径通过ws.path(s, t)获取
+	int query(const Graph& g, int s, int t, QueryWorkspace& ws) const {
+		const CsrAdj& adj = g.adjacency();
+		ws.reset();
+		ws.set_dist(s, 0, s);
+		PriorityQueue3& q = ws.queue();
+		q.add({ s, lower_bound(s, t) });
+		while (!q.empty()) {
+			int u = q.poll().id;
+			ws.count_settled();
+			if (u == t) { break; } // 最短路径！
+			int du = ws.get_dist(u);
+			for (int i = adj.begin(u); i < adj.end(u); ++i) {
+				int v = adj.targets[i], w = adj.weights[i];
+				int nd = sat_add(du, w);
+				if (nd < ws.get_dist(v)) {
+					ws.set_dist(v, nd, u);
+					int f = sat_add(nd, lower_bound(v, t));
+					if (q.contains(v)) {
+						q.decrease_key(v, f);
+					}
+					else {
+						q.add({ v, f });
+					}
+				}
+			}
+		}
+		return ws.get_dist(t);
+	}
+
+	const vector<int>& landmarks() const { return landmark; }
+
+	/*
+	二进制格式：magic "ALT2" | v_num | k | e_num | checksum | landmark[k] | fwd[v_num*k] | bwd[v_num*k]，
+	checksum为uint64(Graph::checksum())，其余均为int32.
+	*/
+	bool save(const std::string& path) const {
+		std::ofstream out(path, std::ios::binary);
+		if (!out) return false;
+		out.write(magic(), 4);
+		write_ints(out, &v_num, 1);
+		write_ints(out, &k, 1);
+		write_ints(out, &e_num, 1);
+		out.write(reinterpret_cast<const char*>(&graph_checksum), sizeof(graph_checksum));
+		write_ints(out, landmark.data(), landmark.size());
+		write_ints(out, fwd.data(), fwd.size());
+		write_ints(out, bwd.data(), bwd.size());
+		return static_cast<bool>(out);
+	}
+
+	// 加载失败时保持原有数据不变；文件必须由同一张图(顶点数、边数与校验和都相同)预处理得到，否则下界可能偏大，查询结果错误
+	bool load(const std::string& path, const Graph& g) {
+		std::ifstream in(path, std::ios::binary);
+		char head[4];
+		int n, kk, m;
+		uint64_t sum;
+		if (!in.read(head, 4) || std::string(head, 4) != magic()) return false;
+		if (!read_ints(in, &n, 1) || !read_ints(in, &kk, 1) || !read_ints(in, &m, 1)) return false;
+		if (!in.read(reinterpret_cast<char*>(&sum), sizeof(sum))) return false;
+		if (n != g.vertex_num() || m != g.edge_num() || kk < 0 || kk > n) return false;
+		if (sum != g.checksum()) return false;
+		vector<int> l(kk), f(static_cast<size_t>(n) * kk), b(static_cast<size_t>(n) * kk);
+		if (!read_ints(in, l.data(), l.size()) || !read_ints(in, f.data(), f.size()) || !read_ints(in, b.data(), b.size())) return false;
+		v_num = n;
+		k = kk;
+		e_num = m;
+		graph_checksum = sum;
+		landmark.swap(l);
+		fwd.swap(f);
+		bwd.swap(b);
+		return true;
+	}
+
+private:
+	static const char* magic() { return "ALT2"; }
+
+	static void write_ints(std::ofstream& out, const int* p, size_t n) {
+		out.write(reinterpret_cast<const char*>(p), static_cast<std::streamsize>(n * sizeof(int32_t)));
+	}
+
+	static bool read_ints(std::ifstream& in, int* p, size_t n) {
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(p), static_cast<std::streamsize>(n * sizeof(int32_t))));
+	}
+
+private:
+	int v_num;
+	int k;
+	int e_num;               // 预处理时图的边数
+	uint64_t graph_checksum; // 预处理时图的校验和
+	vector<int> landmark;
+	vector<int> fwd; // fwd[v*k+i] = d(landmark[i], v)
+	vector<int> bwd; // bwd[v*k+i] = d(v, landmark[i])
+};
+
+#endif // MYCPPPITFALLS_ALT_HPP
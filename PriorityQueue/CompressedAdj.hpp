@@ -0,0 +1,239 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_COMPRESSEDADJ_HPP
+#define MYCPPPITFALLS_COMPRESSEDADJ_HPP
+
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include "ShortestPath.hpp"
+
+// MSVC不定义__SSSE3__，/arch:AVX、/arch:AVX2时定义的__AVX__、__AVX2__蕴含SSSE3；
+// 工程文件已开启/arch:AVX2，gcc/clang需要-mssse3或更高，否则Stream-VByte逐字节解码
+#if defined(__SSSE3__) || defined(__AVX__) || defined(__AVX2__)
+#define COMPRESSEDADJ_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+
+/*
+压缩邻接表：每个顶点的邻居按编号排序后差分编码，第一个邻居存与u之差(zigzag)，其余存与前一个邻居之差.
+   VARINT：每个数用LEB128变长字节编码，每字节7位数据 + 1位续位标志，逐字节解码.
+   STREAM_VBYTE：每4个数共用1个控制字节(每数2位表示1~4字节)，控制字节与数据字节分开存放，
+                 有SSSE3时用查表得到的pshufb掩码一次解出4个数，没有分支预测失败.
+   权重按全图最大值选择1/2/4字节存放.
+   每行的布局为 出度(varint) | 邻居编码 | 权重，全部在同一个字节流中，每个顶点只需一个起始偏移.
+   for_each(u, fn)按需解码一行，Dijkstra无需解压整张图.
+*/
+class CompressedAdj {
+public:
+	enum Scheme { VARINT, STREAM_VBYTE };
+
+	// max_weight决定权重的存储宽度，之后append_row的权重不能超过它
+	explicit CompressedAdj(Scheme s = STREAM_VBYTE, int max_weight = INT_MAX)
+		: v_num(0), scheme(s), weight_width(max_weight < 256 ? 1 : max_weight < 65536 ? 2 : 4),
+		e_num(0), byte_offsets(1, 0), stream(padding, 0) {}
+
+	static CompressedAdj build(const CsrAdj& adj, Scheme s) {
+		int max_w = 0;
+		for (int i = 0; i < adj.edge_num(); ++i) { max_w = std::max(max_w, adj.weights[i]); }
+		CompressedAdj res(s, max_w);
+		vector<std::pair<int, int>> arcs;
+		for (int u = 0; u < adj.vertex_num(); ++u) {
+			arcs.clear();
+			for (int i = adj.begin(u); i < adj.end(u); ++i) { arcs.emplace_back(adj.targets[i], adj.weights[i]); }
+			res.append_row(arcs);
+		}
+		return res;
+	}
+
+	// 追加下一个顶点(编号为当前vertex_num())的出边，arcs为(终点, 权重)，会被排序
+	void append_row(vector<std::pair<int, int>>& arcs) {
+		int u = v_num++;
+		std::sort(arcs.begin(), arcs.end());
+		vector<uint32_t> deltas(arcs.size());
+		for (size_t i = 0; i < arcs.size(); ++i) {
+			deltas[i] = i == 0 ? zigzag(arcs[0].first - u) : static_cast<uint32_t>(arcs[i].first - arcs[i - 1].first);
+		}
+		vector<uint8_t> buf;
+		put_varint(buf, static_cast<uint32_t>(arcs.size()));
+		if (scheme == VARINT) {
+			for (uint32_t x : deltas) { put_varint(buf, x); }
+		}
+		else {
+			size_t ctrl = buf.size();
+			buf.resize(ctrl + (deltas.size() + 3) / 4, 0); // 控制字节在前，数据字节在后
+			for (size_t i = 0; i < deltas.size(); ++i) {
+				int len = byte_len(deltas[i]);
+				buf[ctrl + i / 4] |= static_cast<uint8_t>((len - 1) << (i % 4 * 2));
+				for (int b = 0; b < len; ++b) { buf.push_back(static_cast<uint8_t>(deltas[i] >> (8 * b))); }
+			}
+		}
+		for (auto& a : arcs) {
+			uint32_t w = static_cast<uint32_t>(a.second);
+			for (int b = 0; b < weight_width; ++b) { buf.push_back(static_cast<uint8_t>(w >> (8 * b))); }
+		}
+		stream.insert(stream.end() - padding, buf.begin(), buf.end()); // 末尾始终保留padding个0，SIMD可越界读取
+		byte_offsets.push_back(byte_offsets.back() + buf.size());
+		e_num += arcs.size();
+	}
+
+	int vertex_num() const { return v_num; }
+
+	size_t edge_num() const { return e_num; }
+
+	// 邻接数据占用的字节数，含偏移表
+	size_t bytes() const { return stream.size() + byte_offsets.size() * sizeof(uint64_t); }
+
+	// 顺序调用fn(v, w)遍历u的出边，v按编号升序
+	template<typename Fn>
+	void for_each(int u, Fn fn) const {
+		const uint8_t* p = stream.data() + byte_offsets[u];
+		const uint8_t* end = stream.data() + byte_offsets[u + 1];
+		size_t k = get_varint(p);
+		if (k == 0) return;
+		const uint8_t* w = end - k * weight_width; // 权重位于行尾
+		switch (weight_width) {
+		case 1: decode_row<uint8_t>(u, p, k, w, fn); break;
+		case 2: decode_row<uint16_t>(u, p, k, w, fn); break;
+		default: decode_row<uint32_t>(u, p, k, w, fn); break;
+		}
+	}
+
+private:
+	static constexpr size_t padding = 16;
+
+	static uint32_t zigzag(int d) { return (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31); }
+
+	static int unzigzag(uint32_t x) { return static_cast<int>(x >> 1) ^ -static_cast<int>(x & 1); }
+
+	static void put_varint(vector<uint8_t>& buf, uint32_t x) {
+		for (; x >= 0x80; x >>= 7) { buf.push_back(static_cast<uint8_t>(x | 0x80)); }
+		buf.push_back(static_cast<uint8_t>(x));
+	}
+
+	static uint32_t get_varint(const uint8_t*& p) {
+		uint32_t x = 0;
+		for (int shift = 0; ; shift += 7) {
+			uint8_t b = *p++;
+			x |= static_cast<uint32_t>(b & 0x7f) << shift;
+			if (b < 0x80) return x;
+		}
+	}
+
+	static int byte_len(uint32_t x) { return x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4; }
+
+	template<typename W>
+	static int load_weight(const uint8_t* p, size_t i) {
+		W w;
+		std::memcpy(&w, p + i * sizeof(W), sizeof(W)); // 小端
+		return static_cast<int>(w);
+	}
+
+	// Stream-VByte查表：控制字节 -> 4个数据的总字节数与pshufb掩码
+	struct VByteTable {
+		uint8_t len[256];
+		uint8_t shuffle[256][16];
+
+		VByteTable() {
+			for (int c = 0; c < 256; ++c) {
+				int off = 0;
+				for (int j = 0; j < 4; ++j) {
+					int l = (c >> (2 * j) & 3) + 1;
+					for (int b = 0; b < 4; ++b) { shuffle[c][4 * j + b] = b < l ? static_cast<uint8_t>(off + b) : 0x80; }
+					off += l;
+				}
+				len[c] = static_cast<uint8_t>(off);
+			}
+		}
+	};
+
+	static const VByteTable& vbyte_table() {
+		static const VByteTable table;
+		return table;
+	}
+
+	// 解码4个数据到out，返回消耗的数据字节数
+	static int decode_group(uint8_t ctrl, const uint8_t* data, uint32_t* out) {
+		const VByteTable& table = vbyte_table();
+#if defined(COMPRESSEDADJ_SSSE3)
+		__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		__m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.shuffle[ctrl]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(in, mask));
+#else
+		const uint8_t* p = data;
+		for (int j = 0; j < 4; ++j) {
+			int l = (ctrl >> (2 * j) & 3) + 1;
+			uint32_t x = 0;
+			for (int b = 0; b < l; ++b) { x |= static_cast<uint32_t>(p[b]) << (8 * b); }
+			out[j] = x;
+			p += l;
+		}
+#endif
+		return table.len[ctrl];
+	}
+
+	template<typename W, typename Fn>
+	void decode_row(int u, const uint8_t* p, size_t k, const uint8_t* w, Fn& fn) const {
+		int v = u;
+		if (scheme == VARINT) {
+			for (size_t i = 0; i < k; ++i) {
+				uint32_t x = get_varint(p);
+				v = i == 0 ? u + unzigzag(x) : v + static_cast<int>(x);
+				fn(v, load_weight<W>(w, i));
+			}
+			return;
+		}
+		const uint8_t* ctrl = p;
+		const uint8_t* data = p + (k + 3) / 4;
+		uint32_t out[4];
+		for (size_t g = 0; g * 4 < k; ++g) {
+			data += decode_group(ctrl[g], data, out);
+			size_t cnt = std::min<size_t>(4, k - g * 4);
+			for (size_t j = 0; j < cnt; ++j) {
+				size_t i = g * 4 + j;
+				v = i == 0 ? u + unzigzag(out[0]) : v + static_cast<int>(out[j]);
+				fn(v, load_weight<W>(w, i));
+			}
+		}
+	}
+
+private:
+	int v_num;
+	Scheme scheme;
+	int weight_width;              // 每个权重的字节数
+	size_t e_num;
+	vector<uint64_t> byte_offsets; // 行u在stream中的字节区间
+	vector<uint8_t> stream;        // 编码后的各行
+};
+
+// 在压缩邻接表上的点对点查询，与Graph::query相同
+inline int compressed_query(const CompressedAdj& g, int s, int t, QueryWorkspace& ws) {
+	ws.reset();
+	ws.set_dist(s, 0, s);
+	PriorityQueue3& q = ws.queue();
+	q.add({ s, 0 });
+	while (!q.empty()) {
+		auto curr = q.poll();
+		ws.count_settled();
+		if (curr.id == t) { break; } // 最短路径！
+		g.for_each(curr.id, [&](int v, int w) {
+			int nd = sat_add(curr.dist, w);
+			if (nd < ws.get_dist(v)) {
+				ws.set_dist(v, nd, curr.id);
+				if (q.contains(v)) {
+					q.decrease_key(v, nd);
+				}
+				else {
+					q.add({ v, nd });
+				}
+			}
+		});
+	}
+	return t < 0 ? INF : ws.get_dist(t);
+}
+
+#endif // MYCPPPITFALLS_COMPRESSEDADJ_HPP
@@ -0,0 +1,306 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_CONTRACTIONHIERARCHIES_HPP
+#define MYCPPPITFALLS_CONTRACTIONHIERARCHIES_HPP
+
+#include "ShortestPath.hpp"
+
+
+/*
+收缩层次(Contraction Hierarchies)
+   预处理：按重要性从低到高逐个`收缩`顶点v——删除v，并对每对 u->v->x 判断
+   是否存在不经过v且不长于 w(u,v)+w(v,x) 的见证路径(witness search)，不存在则添加捷径 u->x.
+   收缩顺序用边差(edge difference = 新增捷径数 - 删除边数 + 已收缩邻居数)作优先级，
+   出队时惰性重算，若变大且不再是最小值则重新入队.
+   收缩v时它与尚未收缩邻居之间的边即为`向上`的边，分别存入up(v->高层)与down(高层->v)两张CSR.
+   查询：s在up上、t在down上做双向Dijkstra，只沿层级向上搜索，相遇点中距离和最小者即为最短路；
+   捷径记录了被收缩的中间点mid，递归展开即可还原原图路径.
+*/
+class ContractionHierarchies {
+public:
+	// 查询工作区：正向、反向搜索各一个，以及上一次查询的相遇点；每个线程一个
+	struct Workspace {
+		QueryWorkspace fw;
+		QueryWorkspace bw;
+		int meet;
+
+		Workspace(int v_num) : fw(v_num), bw(v_num), meet(-1) {}
+	};
+
+	ContractionHierarchies() : v_num(0) {}
+
+	// witness_limit: 每次见证搜索最多出队的顶点数，越小预处理越快，但捷径可能越多
+	void preprocess(const Graph& g, int witness_limit = 500) {
+		v_num = g.vertex_num();
+		settle_limit = witness_limit;
+		shortcuts = 0;
+		out_arcs.assign(v_num, {});
+		in_arcs.assign(v_num, {});
+		const CsrAdj& adj = g.adjacency();
+		for (int u = 0; u < v_num; ++u) {
+			for (int i = adj.begin(u); i < adj.end(u); ++i) {
+				if (adj.targets[i] != u) add_arc(u, adj.targets[i], adj.weights[i], -1);
+			}
+		}
+		rank.assign(v_num, -1);
+		deleted_neighbors.assign(v_num, 0);
+		vector<vector<Arc>> up_lists(v_num), down_lists(v_num);
+		QueryWorkspace ws(v_num);
+		PriorityQueue3 order(v_num);
+		vector<int> neighbors;
+		for (int v = 0; v < v_num; ++v) { order.add({ v, priority(v, ws) }); }
+		int next_rank = 0;
+		while (!order.empty()) {
+			Vertex top = order.poll();
+			int p = priority(top.id, ws);
+			if (!order.empty() && p > order.top().dist) { // 惰性更新
+				order.add({ top.id, p });
+				continue;
+			}
+			int v = top.id;
+			rank[v] = next_rank++;
+			up_lists[v] = out_arcs[v];
+			down_lists[v] = in_arcs[v];
+			contract(v, ws);
+			// 同时是入邻居和出邻居的顶点只计一次
+			neighbors.clear();
+			for (auto& a : up_lists[v]) { neighbors.push_back(a.to); }
+			for (auto& a : down_lists[v]) { neighbors.push_back(a.to); }
+			std::sort(neighbors.begin(), neighbors.end());
+			neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+			// 邻居的边差已变化，重算优先级
+			for (int x : neighbors) {
+				++deleted_neighbors[x];
+				order.update({ x, priority(x, ws) });
+			}
+		}
+		vector<vector<Arc>>().swap(out_arcs);
+		vector<vector<Arc>>().swap(in_arcs);
+		up.build(up_lists);
+		down.build(down_lists);
+	}
+
+	// 返回s到t的最短距离(不可达为INF)
+	int query(int s, int t, Workspace& cw) const {
+		QueryWorkspace& fw = cw.fw;
+		QueryWorkspace& bw = cw.bw;
+		fw.reset();
+		bw.reset();
+		fw.set_dist(s, 0, s);
+		bw.set_dist(t, 0, t);
+		PriorityQueue3& fq = fw.queue();
+		PriorityQueue3& bq = bw.queue();
+		fq.add({ s, 0 });
+		bq.add({ t, 0 });
+		int mu = INF;
+		cw.meet = -1;
+		while (!fq.empty() || !bq.empty()) {
+			bool forward = bq.empty() || (!fq.empty() && fq.top().dist <= bq.top().dist);
+			QueryWorkspace& ws = forward ? fw : bw;
+			const QueryWorkspace& other = forward ? bw : fw;
+			const ChAdj& g = forward ? up : down;
+			PriorityQueue3& q = ws.queue();
+			if (q.top().dist >= mu) { // 该方向不可能再找到更短的路径
+				q.clear();
+				continue;
+			}
+			auto curr = q.poll();
+			ws.count_settled();
+			int through = sat_add(curr.dist, other.get_dist(curr.id));
+			if (through < mu) {
+				mu = through;
+				cw.meet = curr.id;
+			}
+			for (int i = g.offsets[curr.id]; i < g.offsets[curr.id + 1]; ++i) {
+				int v = g.targets[i], nd = sat_add(curr.dist, g.weights[i]);
+				if (nd < ws.get_dist(v)) {
+					ws.set_dist(v, nd, curr.id);
+					if (q.contains(v)) {
+						q.decrease_key(v, nd);
+					}
+					else {
+						q.add({ v, nd });
+					}
+				}
+			}
+		}
+		return mu;
+	}
+
+	// 上一次query的原图路径(展开全部捷径)，不可达时为空
+	vector<int> path(int s, int t, const Workspace& cw) const {
+		vector<int> p;
+		if (cw.meet == -1) return p;
+		vector<int> hops = cw.fw.path(s, cw.meet); // s -> meet，沿up边
+		vector<int> back = cw.bw.path(t, cw.meet); // t ... meet，原图方向为 meet -> t
+		hops.insert(hops.end(), back.rbegin() + 1, back.rend());
+		p.push_back(s);
+		for (size_t i = 0; i + 1 < hops.size(); ++i) { unpack(hops[i], hops[i + 1], p); }
+		return p;
+	}
+
+	// 与Graph::print_path/print_dist相同的输出格式
+	void print_path(int s, int t, Workspace& cw) const {
+		int d = query(s, t, cw);
+		vector<int> p = path(s, t, cw);
+		for (size_t i = 0; i < p.size(); ++i) { cout << (i ? "->" : "") << p[i]; }
+		cout << endl << s << "->" << t << ": " << d << endl;
+	}
+
+	int shortcut_num() const { return shortcuts; }
+
+	int vertex_rank(int v) const { return rank[v]; }
+
+private:
+	struct Arc {
+		int to;
+		int w;
+		int mid; // 捷径的中间顶点，原始边为-1
+	};
+
+	// 向上/向下图的紧凑存储：offsets + 三个平行数组
+	struct ChAdj {
+		vector<int> offsets;
+		vector<int> targets;
+		vector<int> weights;
+		vector<int> mids;
+
+		void build(const vector<vector<Arc>>& lists) {
+			offsets.assign(lists.size() + 1, 0);
+			for (size_t u = 0; u < lists.size(); ++u) { offsets[u + 1] = offsets[u] + static_cast<int>(lists[u].size()); }
+			targets.clear();
+			weights.clear();
+			mids.clear();
+			for (auto& l : lists) {
+				for (auto& a : l) {
+					targets.push_back(a.to);
+					weights.push_back(a.w);
+					mids.push_back(a.mid);
+				}
+			}
+		}
+	};
+
+	// 加入u->x，已有平行边时只保留较短者
+	void add_arc(int u, int x, int w, int mid) {
+		for (auto& a : out_arcs[u]) {
+			if (a.to != x) continue;
+			if (w < a.w) {
+				a.w = w;
+				a.mid = mid;
+				for (auto& b : in_arcs[x]) {
+					if (b.to == u) { b.w = w; b.mid = mid; }
+				}
+			}
+			return;
+		}
+		out_arcs[u].push_back({ x, w, mid });
+		in_arcs[x].push_back({ u, w, mid });
+	}
+
+	static void remove_arcs_to(vector<Arc>& arcs, int v) {
+		size_t k = 0;
+		for (auto& a : arcs) {
+			if (a.to != v) arcs[k++] = a;
+		}
+		arcs.resize(k);
+	}
+
+	// 从u出发、不经过v和已收缩顶点的有限Dijkstra，距离超过limit或出队数达到上限即停止
+	void witness_search(int u, int v, int limit, QueryWorkspace& ws) const {
+		ws.reset();
+		ws.set_dist(u, 0, u);
+		PriorityQueue3& q = ws.queue();
+		q.add({ u, 0 });
+		while (!q.empty() && ws.settled_num() < settle_limit) {
+			auto curr = q.poll();
+			ws.count_settled();
+			if (curr.dist > limit) break;
+			for (auto& a : out_arcs[curr.id]) {
+				if (a.to == v || rank[a.to] != -1) continue;
+				int d = sat_add(curr.dist, a.w);
+				if (d < ws.get_dist(a.to)) {
+					ws.set_dist(a.to, d, curr.id);
+					if (q.contains(a.to)) {
+						q.decrease_key(a.to, d);
+					}
+					else {
+						q.add({ a.to, d });
+					}
+				}
+			}
+		}
+	}
+
+	// 对v的每条入边做见证搜索，apply为false时只统计需要添加的捷径数
+	int shortcuts_of(int v, bool apply, QueryWorkspace& ws) {
+		int added = 0;
+		int max_out = 0;
+		for (auto& a : out_arcs[v]) { max_out = std::max(max_out, a.w); }
+		for (auto& in : in_arcs[v]) {
+			witness_search(in.to, v, sat_add(in.w, max_out), ws);
+			for (auto& out : out_arcs[v]) {
+				if (out.to == in.to) continue;
+				int w = sat_add(in.w, out.w);
+				if (ws.get_dist(out.to) <= w) continue; // 存在见证路径
+				++added;
+				if (apply) add_arc(in.to, out.to, w, v);
+			}
+		}
+		return added;
+	}
+
+	int priority(int v, QueryWorkspace& ws) {
+		int edges = static_cast<int>(in_arcs[v].size() + out_arcs[v].size());
+		return shortcuts_of(v, false, ws) - edges + deleted_neighbors[v];
+	}
+
+	void contract(int v, QueryWorkspace& ws) {
+		shortcuts += shortcuts_of(v, true, ws);
+		for (auto& a : out_arcs[v]) { remove_arcs_to(in_arcs[a.to], v); }
+		for (auto& a : in_arcs[v]) { remove_arcs_to(out_arcs[a.to], v); }
+		out_arcs[v].clear();
+		in_arcs[v].clear();
+	}
+
+	// 找u->x的弧(取最短)：低层顶点的向上边在up中，高层到低层的边在down中
+	void find_arc(int u, int x, int& w, int& mid) const {
+		w = INF;
+		mid = -1;
+		const ChAdj& g = rank[u] < rank[x] ? up : down;
+		int from = rank[u] < rank[x] ? u : x, to = rank[u] < rank[x] ? x : u;
+		for (int i = g.offsets[from]; i < g.offsets[from + 1]; ++i) {
+			if (g.targets[i] == to && g.weights[i] < w) {
+				w = g.weights[i];
+				mid = g.mids[i];
+			}
+		}
+	}
+
+	void unpack(int u, int x, vector<int>& p) const {
+		int w, mid;
+		find_arc(u, x, w, mid);
+		if (mid == -1) {
+			p.push_back(x);
+			return;
+		}
+		unpack(u, mid, p);
+		unpack(mid, x, p);
+	}
+
+private:
+	int v_num;
+	int settle_limit = 500;
+	int shortcuts = 0;
+	vector<int> rank; // 收缩顺序，越大越重要
+	vector<int> deleted_neighbors;
+	vector<vector<Arc>> out_arcs; // 预处理期间的动态图
+	vector<vector<Arc>> in_arcs;
+	ChAdj up;   // up[v]: v -> 更高层顶点
+	ChAdj down; // down[v]: 更高层顶点 -> v，反向搜索使用
+};
+
+#endif // MYCPPPITFALLS_CONTRACTIONHIERARCHIES_HPP
@@ -0,0 +1,232 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_DARYHEAP_HPP
+#define MYCPPPITFALLS_DARYHEAP_HPP
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include "PriorityQueue.hpp"
+
+// MSVC不定义__SSE4_1__，/arch:AVX、/arch:AVX2时定义__AVX__、__AVX2__，AVX蕴含SSE4.1；
+// 工程文件已开启/arch:AVX2，gcc/clang需要-mavx2或-msse4.1，否则只用标量比较
+#if defined(__AVX2__)
+#define DARY_AVX2 1
+#endif
+#if defined(__AVX2__) || defined(__AVX__) || defined(__SSE4_1__)
+#define DARY_SSE41 1
+#endif
+
+#if defined(DARY_AVX2)
+#include <immintrin.h>
+#elif defined(DARY_SSE41)
+#include <smmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+/*
+5. 缓存对齐的D叉堆 `DaryHeap<D>`
+   D=4/8时树高只有二叉堆的1/2、1/3，下沉次数少；
+   dist单独存放在64字节对齐的keys数组中，并整体偏移D-1个位置，
+   使得每个节点的D个孩子恰好是一个对齐的块(4个int=16字节，8个int=32字节)，
+   一次SSE/AVX2加载即可选出最小孩子；无SIMD时退化为标量比较.
+   只有D=4(SSE4.1)和D=8(SSE4.1或AVX2)有SIMD路径，D=2、D=16始终是标量比较.
+   与PriorityQueue3一样维护 id->堆下标 的索引，支持O(logn)的decrease_key.
+*/
+namespace dary {
+
+inline int lowest_bit(unsigned mask) {
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward(&idx, mask);
+	return static_cast<int>(idx);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// 返回对齐块k[0..D)中最小值的下标，空位已填充为int最大值
+template<int D>
+inline int min_child(const int* k) {
+	int m = 0;
+	for (int j = 1; j < D; ++j) {
+		if (k[j] < k[m]) m = j;
+	}
+	return m;
+}
+
+#if defined(DARY_SSE41)
+inline __m128i hmin4(__m128i v) {
+	__m128i m = _mm_min_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+template<>
+inline int min_child<4>(const int* k) {
+	__m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(k));
+	__m128i eq = _mm_cmpeq_epi32(v, hmin4(v));
+	return lowest_bit(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq))));
+}
+#endif
+
+#if defined(DARY_AVX2)
+template<>
+inline int min_child<8>(const int* k) {
+	__m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(k));
+	__m256i m = _mm256_min_epi32(v, _mm256_permute2x128_si256(v, v, 1));
+	m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+	m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+	__m256i eq = _mm256_cmpeq_epi32(v, m);
+	return lowest_bit(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq))));
+}
+#elif defined(DARY_SSE41)
+template<>
+inline int min_child<8>(const int* k) {
+	__m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(k));
+	__m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(k + 4));
+	__m128i m = hmin4(_mm_min_epi32(lo, hi));
+	unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, m))))
+		| static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, m)))) << 4;
+	return lowest_bit(mask);
+}
+#endif
+
+} // namespace dary
+
+
+template<int D>
+class DaryHeap {
+	static_assert(D == 2 || D == 4 || D == 8 || D == 16, "D must be a power of two not larger than 16"); // D=2/16没有SIMD路径
+
+public:
+	DaryHeap(int c) : capacity(c), count(0), ids(c), pos(c, -1) {
+		// 多分配2D个哨兵位，保证最后一个孩子块完整；再多分配一个缓存行用于对齐
+		key_buf.assign(capacity + 2 * D + cache_line / sizeof(int), EMPTY);
+		auto addr = reinterpret_cast<std::uintptr_t>(key_buf.data());
+		size_t skip = (cache_line - addr % cache_line) % cache_line / sizeof(int);
+		keys = key_buf.data() + skip + (D - 1); // 孩子块keys+D*i+1 = 对齐起点+D*(i+1)
+	}
+	DaryHeap(const DaryHeap&) = delete; // keys指向key_buf内部，禁止拷贝
+	DaryHeap& operator=(const DaryHeap&) = delete;
+
+	void add(Vertex&& data) {
+		if (count >= capacity || contains(data.id)) return;
+		int i = count++;
+		ids[i] = data.id;
+		keys[i] = data.dist;
+		pos[data.id] = i;
+		heapify_float(i);
+	}
+
+	Vertex poll() {
+		if (count == 0) return {};
+		Vertex top(ids[0], keys[0]);
+		remove_at(0);
+		return top;
+	}
+
+	void update(Vertex&& data) {
+		if (!contains(data.id)) return;
+		int i = pos[data.id];
+		int old = keys[i];
+		keys[i] = data.dist;
+		if (data.dist < old) heapify_float(i);
+		else heapify_sink(i);
+	}
+
+	void decrease_key(int id, int dist) {
+		if (!contains(id)) return;
+		int i = pos[id];
+		if (dist >= keys[i]) return;
+		keys[i] = dist;
+		heapify_float(i);
+	}
+
+	void erase(int id) {
+		if (!contains(id)) return;
+		remove_at(pos[id]);
+	}
+
+	bool contains(int id) const { return pos[id] != -1; }
+
+	bool empty() const { return count == 0; }
+
+	int size() const { return count; }
+
+private:
+	static constexpr int EMPTY = std::numeric_limits<int>::max();
+	static constexpr size_t cache_line = 64;
+
+	void remove_at(int i) {
+		pos[ids[i]] = -1;
+		--count;
+		if (i != count) {
+			ids[i] = ids[count];
+			keys[i] = keys[count];
+			pos[ids[i]] = i;
+		}
+		keys[count] = EMPTY; // 空位填充最大值，SIMD选最小孩子时无需判断越界
+		if (i < count) {
+			heapify_float(i);
+			heapify_sink(i);
+		}
+	}
+
+	// 空穴上浮：父节点下移，最后一次性写入
+	void heapify_float(int i) {
+		int id = ids[i], key = keys[i];
+		while (i > 0) {
+			int p = (i - 1) / D;
+			if (keys[p] <= key) break;
+			move(p, i);
+			i = p;
+		}
+		place(i, id, key);
+	}
+
+	// 空穴下沉：每层用一次SIMD比较选出最小孩子
+	void heapify_sink(int i) {
+		int id = ids[i], key = keys[i];
+		while (true) {
+			int c = D * i + 1;
+			if (c >= count) break;
+			int m = c + dary::min_child<D>(keys + c);
+			if (keys[m] >= key) break;
+			move(m, i);
+			i = m;
+		}
+		place(i, id, key);
+	}
+
+	void move(int from, int to) {
+		ids[to] = ids[from];
+		keys[to] = keys[from];
+		pos[ids[to]] = to;
+	}
+
+	void place(int i, int id, int key) {
+		ids[i] = id;
+		keys[i] = key;
+		pos[id] = i;
+	}
+
+private:
+	int capacity;
+	int count;
+	std::vector<int> key_buf; // keys的底层存储
+	int* keys;                // 64字节对齐后偏移D-1，keys[i]为堆下标i的dist
+	std::vector<int> ids;     // 堆下标 -> id
+	std::vector<int> pos;     // id -> 堆下标，-1表示不在堆中
+};
+
+template<int D> constexpr int DaryHeap<D>::EMPTY;
+template<int D> constexpr size_t DaryHeap<D>::cache_line;
+
+#endif // MYCPPPITFALLS_DARYHEAP_HPP
@@ -0,0 +1,143 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_DELTASTEPPING_HPP
+#define MYCPPPITFALLS_DELTASTEPPING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "ShortestPath.hpp"
+
+
+/*
+并行Delta-Stepping单源最短路
+   按 dist/Δ 把顶点放入桶中，同一个桶内的顶点并行松弛；
+   w<=Δ 的轻边可能把顶点放回当前桶，需反复处理直到当前桶为空，
+   w>Δ 的重边只会放入后面的桶，当前桶清空后对本轮所有出桶顶点统一松弛一次.
+   dist与predecessor打包成一个64位原子量(高32位dist，低32位前驱)，
+   CAS取最小值，保证并发下两者始终一致.
+   Δ越小越接近Dijkstra(工作量少、并行度低)，越大越接近Bellman-Ford.
+*/
+class DeltaStepping {
+public:
+	DeltaStepping(const Graph& g, int d) : v_num(g.vertex_num()), delta(d > 0 ? d : 1), max_w(0) {
+		// 每行重排为轻边在前、重边在后，light_end[u]为分界
+		const CsrAdj& adj = g.adjacency();
+		offsets.assign(adj.offsets, adj.offsets + v_num + 1);
+		targets.resize(adj.edge_num());
+		weights.resize(adj.edge_num());
+		light_end.resize(v_num);
+		for (int u = 0; u < v_num; ++u) {
+			int lo = adj.begin(u), hi = adj.end(u);
+			for (int i = adj.begin(u); i < adj.end(u); ++i) {
+				int k = adj.weights[i] <= delta ? lo++ : --hi;
+				targets[k] = adj.targets[i];
+				weights[k] = adj.weights[i];
+				if (adj.weights[i] > max_w) max_w = adj.weights[i];
+			}
+			light_end[u] = lo;
+		}
+		bucket_num = max_w / delta + 2; // 一次松弛最多跨越max_w/Δ个桶，循环使用
+	}
+
+	void run(int s, ThreadPool& pool) {
+		state.reset(new std::atomic<uint64_t>[v_num]);
+		for (int v = 0; v < v_num; ++v) { state[v].store(pack(INF, -1), std::memory_order_relaxed); }
+		vector<vector<int>> buckets(bucket_num);
+		vector<vector<int>> local(pool.size()); // 每个线程新入桶的顶点
+		vector<int> mark(v_num, -1);            // 去重：同一轮中只处理一次
+		state[s].store(pack(0, s));
+		buckets[0].push_back(s);
+		size_t pending = 1;
+		int round = 0;
+		for (long long cur = 0; pending > 0; ++cur) {
+			vector<int>& bucket = buckets[cur % bucket_num];
+			if (bucket.empty()) continue;
+			vector<int> settled; // 本桶出桶的全部顶点，最后统一松弛重边
+			while (!bucket.empty()) {
+				vector<int> frontier;
+				++round;
+				for (int v : bucket) {
+					if (mark[v] != round && dist_of(v) / delta == cur) {
+						mark[v] = round;
+						frontier.push_back(v);
+					}
+				}
+				pending -= bucket.size();
+				bucket.clear();
+				settled.insert(settled.end(), frontier.begin(), frontier.end());
+				pending += relax(frontier, true, pool, local, buckets);
+			}
+			pending += relax(settled, false, pool, local, buckets);
+		}
+		dist.resize(v_num);
+		predecessor.resize(v_num);
+		for (int v = 0; v < v_num; ++v) {
+			uint64_t x = state[v].load(std::memory_order_relaxed);
+			dist[v] = static_cast<int>(x >> 32);
+			predecessor[v] = static_cast<int>(static_cast<uint32_t>(x));
+		}
+		state.reset();
+	}
+
+	const vector<int>& distances() const { return dist; }
+
+	// 不可达顶点的前驱为-1，起点的前驱为自身
+	const vector<int>& predecessors() const { return predecessor; }
+
+private:
+	static uint64_t pack(int d, int pre) {
+		return static_cast<uint64_t>(static_cast<uint32_t>(d)) << 32 | static_cast<uint32_t>(pre);
+	}
+
+	int dist_of(int v) const { return static_cast<int>(state[v].load(std::memory_order_relaxed) >> 32); }
+
+	// 原子地取最小值，返回是否更新成功
+	bool try_update(int v, int d, int pre) {
+		uint64_t old = state[v].load(std::memory_order_relaxed);
+		uint64_t val = pack(d, pre);
+		while (d < static_cast<int>(old >> 32)) {
+			if (state[v].compare_exchange_weak(old, val, std::memory_order_relaxed)) return true;
+		}
+		return false;
+	}
+
+	// 并行松弛frontier的轻边或重边，更新成功的顶点先放入线程本地列表，再合并到桶中
+	size_t relax(const vector<int>& frontier, bool light, ThreadPool& pool,
+		vector<vector<int>>& local, vector<vector<int>>& buckets) {
+		pool.parallel_for(frontier.size(), [&](size_t k, int tid) {
+			int u = frontier[k];
+			int du = dist_of(u);
+			int begin = light ? offsets[u] : light_end[u];
+			int end = light ? light_end[u] : offsets[u + 1];
+			for (int i = begin; i < end; ++i) {
+				int v = targets[i];
+				if (try_update(v, sat_add(du, weights[i]), u)) { local[tid].push_back(v); }
+			}
+		}, 64);
+		size_t added = 0;
+		for (auto& l : local) {
+			for (int v : l) { buckets[(dist_of(v) / delta) % bucket_num].push_back(v); }
+			added += l.size();
+			l.clear();
+		}
+		return added;
+	}
+
+private:
+	int v_num;
+	int delta;
+	int max_w;
+	int bucket_num;
+	vector<int> offsets;
+	vector<int> targets;
+	vector<int> weights;
+	vector<int> light_end;
+	std::unique_ptr<std::atomic<uint64_t>[]> state; // 打包的(dist, predecessor)
+	vector<int> dist;
+	vector<int> predecessor;
+};
+
+#endif // MYCPPPITFALLS_DELTASTEPPING_HPP
@@ -0,0 +1,136 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_DYNAMICSSSP_HPP
+#define MYCPPPITFALLS_DYNAMICSSSP_HPP
+
+#include "ShortestPath.hpp"
+
+
+/*
+动态单源最短路(Ramalingam–Reps)
+   保存从source出发的最短路树(dist + predecessor)，图上一批边权改变后只修复受影响的部分：
+   1. 权重增大/删除：若被改的边是树边且dist[u]+w不再等于dist[v]，v成为候选.
+      候选按原dist从小到大出队，若存在正权入边(y,v)使y未受影响且 dist[y]+w == dist[v]，
+      则v换一个前驱即可，距离不变；否则v受影响，它的树上子节点成为新的候选.
+   2. 受影响顶点的dist置为INF，并用来自未受影响顶点的入边给出初始估计放入队列；
+      权重减小的边若能缩短终点距离也放入队列，之后做普通的Dijkstra传播.
+   工作量只与受影响的顶点及其邻边成正比，变化很小时远少于重新计算.
+*/
+class DynamicSSSP {
+public:
+	DynamicSSSP(const Graph& g, int s) : source(s), q(g.vertex_num()), state(g.vertex_num(), FREE) {
+		recompute(g);
+	}
+
+	// 从头计算，图的顶点数变化或修改量很大时使用
+	void recompute(const Graph& g) {
+		g.dijkstra<IndexedHeapPolicy>(source, -1, dist, predecessor);
+		touched = static_cast<int>(dist.size());
+	}
+
+	/*
+	changed为已通过Graph::update_edge/remove_edge修改过的边(s, t)，可以同时包含增大和减小；
+	g必须是修改后的图. 返回本次被重新确定距离的顶点数.
+	*/
+	int repair(const Graph& g, const vector<std::pair<int, int>>& changed) {
+		const CsrAdj& adj = g.adjacency();
+		const CsrAdj& radj = g.reverse_adjacency();
+		touched = 0;
+		vector<int> affected;
+		// 第1步：找出距离必然变大的顶点
+		for (auto& c : changed) {
+			int u = c.first, v = c.second;
+			if (predecessor[v] != u || v == source || state[v] != FREE) continue;
+			if (sat_add(dist[u], g.edge_weight(u, v)) > dist[v]) { // 树边变长或被删除；变短的边在第2步松弛
+				state[v] = CANDIDATE;
+				q.add({ v, dist[v] });
+			}
+		}
+		while (!q.empty()) {
+			int v = q.poll().id;
+			int pre = -1;
+			for (int i = radj.begin(v); i < radj.end(v); ++i) {
+				int y = radj.targets[i];
+				if (radj.weights[i] > 0 && state[y] == FREE && dist[y] < INF && sat_add(dist[y], radj.weights[i]) == dist[v]) {
+					pre = y;
+					break;
+				}
+			}
+			if (pre != -1) { // 仍有等长的最短路
+				predecessor[v] = pre;
+				state[v] = FREE;
+				continue;
+			}
+			state[v] = AFFECTED;
+			affected.push_back(v);
+			for (int i = adj.begin(v); i < adj.end(v); ++i) {
+				int x = adj.targets[i];
+				if (predecessor[x] == v && state[x] == FREE && x != source) {
+					state[x] = CANDIDATE;
+					q.add({ x, dist[x] });
+				}
+			}
+		}
+		// 第2步：受影响顶点从未受影响的邻居处取初始估计
+		for (int v : affected) {
+			dist[v] = INF;
+			predecessor[v] = -1;
+		}
+		for (int v : affected) {
+			state[v] = FREE;
+			for (int i = radj.begin(v); i < radj.end(v); ++i) {
+				relax(radj.targets[i], v, radj.weights[i]);
+			}
+		}
+		for (auto& c : changed) {
+			relax(c.first, c.second, g.edge_weight(c.first, c.second));
+		}
+		while (!q.empty()) {
+			auto curr = q.poll();
+			++touched;
+			for (int i = adj.begin(curr.id); i < adj.end(curr.id); ++i) {
+				relax(curr.id, adj.targets[i], adj.weights[i]);
+			}
+		}
+		return touched;
+	}
+
+	int root() const { return source; }
+
+	const vector<int>& distances() const { return dist; }
+
+	// 不可达顶点的前驱为-1，起点的前驱为自身
+	const vector<int>& predecessors() const { return predecessor; }
+
+	// 上一次repair(或recompute)重新确定距离的顶点数
+	int touched_num() const { return touched; }
+
+private:
+	enum State : char { FREE, CANDIDATE, AFFECTED };
+
+	void relax(int u, int v, int w) {
+		int nd = sat_add(dist[u], w);
+		if (nd >= dist[v]) return;
+		dist[v] = nd;
+		predecessor[v] = u;
+		if (q.contains(v)) {
+			q.decrease_key(v, dist[v]);
+		}
+		else {
+			q.add({ v, dist[v] });
+		}
+	}
+
+private:
+	int source;
+	vector<int> dist;
+	vector<int> predecessor;
+	PriorityQueue3 q;
+	vector<State> state;
+	int touched;
+};
+
+#endif // MYCPPPITFALLS_DYNAMICSSSP_HPP
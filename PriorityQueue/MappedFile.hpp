@@ -0,0 +1,95 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_MAPPEDFILE_HPP
+#define MYCPPPITFALLS_MAPPEDFILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // 避免windows.h的min/max宏与std::min/std::max冲突
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+/*
+只读内存映射文件：整个文件映射为一段连续内存，页面由操作系统按需调入，
+多个进程映射同一文件时共享同一份物理页(page cache).
+*/
+class MappedFile {
+public:
+	MappedFile() : ptr(nullptr), len(0) {}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() { close(); }
+
+	bool open(const std::string& path) {
+		close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file); // 映射对象持有文件的引用
+		if (mapping == nullptr) return false;
+		void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping); // 视图持有映射对象的引用
+		if (p == nullptr) return false;
+		len = static_cast<size_t>(size.QuadPart);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			::close(fd);
+			return false;
+		}
+		void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd); // 映射建立后即可关闭文件描述符
+		if (p == MAP_FAILED) return false;
+		len = static_cast<size_t>(st.st_size);
+#endif
+		ptr = static_cast<const char*>(p);
+		return true;
+	}
+
+	void close() {
+		if (ptr == nullptr) return;
+#ifdef _WIN32
+		UnmapViewOfFile(ptr);
+#else
+		munmap(const_cast<char*>(ptr), len);
+#endif
+		ptr = nullptr;
+		len = 0;
+	}
+
+	const char* data() const { return ptr; }
+
+	size_t size() const { return len; }
+
+private:
+	const char* ptr; // 映射起始地址，按页对齐
+	size_t len;
+};
+
+#endif // MYCPPPITFALLS_MAPPEDFILE_HPP
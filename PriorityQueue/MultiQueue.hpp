@@ -0,0 +1,203 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_MULTIQUEUE_HPP
+#define MYCPPPITFALLS_MULTIQUEUE_HPP
+
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include "ShortestPath.hpp"
+
+
+/*
+自旋锁：只提供try_lock，test-and-test-and-set，锁被占用时只读不写，避免锁所在缓存行在核间来回失效；
+MultiQueue获取失败就换一个堆，从不等待. 临界区只有一次堆操作，比std::mutex的系统调用路径轻得多.
+*/
+class SpinLock {
+public:
+	SpinLock() : locked(false) {}
+	SpinLock(const SpinLock&) = delete;
+	SpinLock& operator=(const SpinLock&) = delete;
+
+	bool try_lock() { return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire); }
+
+	void unlock() { locked.store(false, std::memory_order_release); }
+
+private:
+	std::atomic<bool> locked;
+};
+
+
+/*
+7. 松弛的并发优先队列 `MultiQueue`
+   内部有 c*P 个PriorityQueue1(P为线程数)，每个配一把自旋锁：
+   push随机选一个堆，锁被占用就换一个，不等待；
+   pop随机选两个堆，比较各自缓存的堆顶dist，从较小的一个出队(two-choice).
+   出队的不一定是全局最小值，但期望名次误差为O(c*P)，换来几乎没有锁竞争.
+   堆不带位置表，同一顶点重复入队(惰性删除)，由使用者在出队时跳过过期元素；
+   内存与当前元素数成正比，不再随 c*P*V 增长.
+*/
+class MultiQueue {
+public:
+	MultiQueue(int threads, int c = 2) : count(0) {
+		int k = std::max(threads, 1) * std::max(c, 1);
+		for (int i = 0; i < k; ++i) { lanes.emplace_back(new Lane()); }
+	}
+
+	void push(int id, int dist) {
+		while (true) {
+			Lane& lane = *lanes[random() % lanes.size()];
+			if (!lane.lock.try_lock()) continue;
+			lane.heap.emplace(id, dist);
+			count.fetch_add(1, std::memory_order_relaxed);
+			lane.top.store(lane.heap.top().dist, std::memory_order_relaxed);
+			lane.lock.unlock();
+			return;
+		}
+	}
+
+	// 近似最小的元素出队；所有堆都为空时返回false
+	bool try_pop(Vertex& out) {
+		while (count.load(std::memory_order_relaxed) > 0) {
+			size_t i = random() % lanes.size(), j = random() % lanes.size();
+			if (lanes[j]->top.load(std::memory_order_relaxed) < lanes[i]->top.load(std::memory_order_relaxed)) i = j;
+			Lane& lane = *lanes[i];
+			if (lane.top.load(std::memory_order_relaxed) == INF || !lane.lock.try_lock()) continue;
+			if (lane.heap.empty()) {
+				lane.lock.unlock();
+				continue;
+			}
+			out = lane.heap.top();
+			lane.heap.pop();
+			lane.top.store(lane.heap.empty() ? INF : lane.heap.top().dist, std::memory_order_relaxed);
+			lane.lock.unlock();
+			count.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	// 并发修改时只是近似值
+	size_t size() const { return static_cast<size_t>(std::max<long long>(count.load(std::memory_order_relaxed), 0)); }
+
+	int queue_num() const { return static_cast<int>(lanes.size()); }
+
+private:
+	struct Lane {
+		SpinLock lock;
+		std::atomic<int> top; // 堆顶dist的副本，空堆为INF，挑选时无需加锁
+		PriorityQueue1 heap;
+		char pad[64];         // 相邻两个Lane的锁不落在同一缓存行
+
+		Lane() : top(INF) {}
+	};
+
+	// 每个线程独立的xorshift随机数
+	static uint32_t random() {
+		static thread_local uint32_t x = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		return x;
+	}
+
+private:
+	vector<std::unique_ptr<Lane>> lanes;
+	std::atomic<long long> count; // 各堆元素总数
+};
+
+
+/*
+基于MultiQueue的并行标号修正(label-correcting)单源最短路
+   所有线程反复从MultiQueue取出近似最小的顶点并松弛其出边，dist与前驱打包为64位原子量，CAS取最小值.
+   出队顺序不严格，一个顶点可能被处理多次(出队时dist已变小的直接跳过)，结果仍是精确的最短距离.
+   pending记录已入队但尚未处理完的元素数，松弛出的新元素先计入再入队，降为0时全部线程退出.
+*/
+class MultiQueueSSSP {
+public:
+	MultiQueueSSSP(const Graph& g, int c = 2) : graph(g), v_num(g.vertex_num()), factor(c), processed(0) {}
+
+	void run(int s, ThreadPool& pool) {
+		state.reset(new std::atomic<uint64_t>[v_num]);
+		for (int v = 0; v < v_num; ++v) { state[v].store(pack(INF, -1), std::memory_order_relaxed); }
+		state[s].store(pack(0, s));
+		MultiQueue q(pool.size(), factor);
+		std::atomic<long long> pending(1);
+		std::atomic<size_t> pops(0);
+		q.push(s, 0);
+		const CsrAdj& adj = graph.adjacency();
+		pool.run([&](int) {
+			size_t local = 0;
+			Vertex curr;
+			while (pending.load(std::memory_order_acquire) > 0) {
+				if (!q.try_pop(curr)) {
+					std::this_thread::yield(); // 其他线程正在处理，稍后可能有新元素
+					continue;
+				}
+				if (curr.dist <= dist_of(curr.id)) {
+					++local;
+					for (int i = adj.begin(curr.id); i < adj.end(curr.id); ++i) {
+						int v = adj.targets[i], d = sat_add(curr.dist, adj.weights[i]);
+						if (try_update(v, d, curr.id)) {
+							pending.fetch_add(1, std::memory_order_relaxed);
+							q.push(v, d);
+						}
+					}
+				}
+				pending.fetch_sub(1, std::memory_order_release);
+			}
+			pops.fetch_add(local, std::memory_order_relaxed);
+		});
+		processed = pops.load();
+		dist.resize(v_num);
+		predecessor.resize(v_num);
+		for (int v = 0; v < v_num; ++v) {
+			uint64_t x = state[v].load(std::memory_order_relaxed);
+			dist[v] = static_cast<int>(x >> 32);
+			predecessor[v] = static_cast<int>(static_cast<uint32_t>(x));
+		}
+		state.reset();
+	}
+
+	const vector<int>& distances() const { return dist; }
+
+	// 不可达顶点的前驱为-1，起点的前驱为自身
+	const vector<int>& predecessors() const { return predecessor; }
+
+	// 上一次run()中实际松弛过出边的出队次数，超出可达顶点数的部分即松弛顺序带来的额外工作
+	size_t processed_num() const { return processed; }
+
+private:
+	static uint64_t pack(int d, int pre) {
+		return static_cast<uint64_t>(static_cast<uint32_t>(d)) << 32 | static_cast<uint32_t>(pre);
+	}
+
+	int dist_of(int v) const { return static_cast<int>(state[v].load(std::memory_order_relaxed) >> 32); }
+
+	bool try_update(int v, int d, int pre) {
+		uint64_t old = state[v].load(std::memory_order_relaxed);
+		uint64_t val = pack(d, pre);
+		while (d < static_cast<int>(old >> 32)) {
+			if (state[v].compare_exchange_weak(old, val, std::memory_order_relaxed)) return true;
+		}
+		return false;
+	}
+
+private:
+	const Graph& graph;
+	int v_num;
+	int factor; // 每个线程的堆数c
+	size_t processed;
+	std::unique_ptr<std::atomic<uint64_t>[]> state; // 打包的(dist, predecessor)
+	vector<int> dist;
+	vector<int> predecessor;
+};
+
+#endif // MYCPPPITFALLS_MULTIQUEUE_HPP
@@ -0,0 +1,122 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_PATHCACHE_HPP
+#define MYCPPPITFALLS_PATHCACHE_HPP
+
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include "ShortestPath.hpp"
+
+
+// 以source为根的完整最短路树，不可达顶点dist为INF、前驱为-1
+struct ShortestPathTree {
+	int source;
+	vector<int> dist;
+	vector<int> predecessor;
+
+	// s到t的路径，沿前驱回溯，O(路径长度)；不可达时为空
+	vector<int> path(int t) const {
+		vector<int> p;
+		if (dist[t] >= INF) return p;
+		for (int v = t; v != source; v = predecessor[v]) { p.push_back(v); }
+		p.push_back(source);
+		std::reverse(p.begin(), p.end());
+		return p;
+	}
+
+	size_t bytes() const { return sizeof(*this) + (dist.capacity() + predecessor.capacity()) * sizeof(int); }
+};
+
+
+/*
+最短路树缓存：按起点缓存完整的Dijkstra结果，同一起点的后续查询(任意终点)无需再搜索.
+   LRU淘汰：命中的树移到链表头部，总字节数超过上限时从尾部淘汰；单棵树超过上限时只返回不缓存.
+   树以shared_ptr返回，被淘汰后调用者手中的结果仍然有效.
+   加锁保护，可在线程间共享；未命中时的Dijkstra在锁外执行.
+   图被update_edge/remove_edge修改后须调用clear().
+*/
+class PathCache {
+public:
+	struct Stats {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+		size_t bytes = 0;   // 当前缓存占用
+		size_t entries = 0; // 当前缓存的树数
+	};
+
+	PathCache(const Graph& g, size_t max_bytes) : graph(g), capacity(max_bytes) {}
+
+	std::shared_ptr<const ShortestPathTree> tree(int s) {
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			auto iter = index.find(s);
+			if (iter != index.end()) {
+				++stat.hits;
+				lru.splice(lru.begin(), lru, iter->second); // 移到头部，迭代器不失效
+				return *iter->second;
+			}
+			++stat.misses;
+		}
+		std::shared_ptr<ShortestPathTree> t(new ShortestPathTree());
+		t->source = s;
+		graph.dijkstra<IndexedHeapPolicy>(s, -1, t->dist, t->predecessor);
+		std::lock_guard<std::mutex> lock(mtx);
+		auto iter = index.find(s);
+		if (iter != index.end()) return *iter->second; // 其他线程已插入
+		size_t bytes = t->bytes();
+		if (bytes > capacity) return t;
+		while (stat.bytes + bytes > capacity) { evict(); }
+		lru.push_front(t);
+		index[s] = lru.begin();
+		stat.bytes += bytes;
+		stat.entries = lru.size();
+		return t;
+	}
+
+	int query(int s, int t) { return tree(s)->dist[t]; }
+
+	vector<int> path(int s, int t) { return tree(s)->path(t); }
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(mtx);
+		lru.clear();
+		index.clear();
+		stat.bytes = 0;
+		stat.entries = 0;
+	}
+
+	Stats stats() const {
+		std::lock_guard<std::mutex> lock(mtx);
+		return stat;
+	}
+
+	double hit_rate() const {
+		Stats s = stats();
+		return s.hits + s.misses == 0 ? 0 : static_cast<double>(s.hits) / (s.hits + s.misses);
+	}
+
+private:
+	void evict() {
+		auto& victim = lru.back();
+		stat.bytes -= victim->bytes();
+		index.erase(victim->source);
+		lru.pop_back();
+		++stat.evictions;
+		stat.entries = lru.size();
+	}
+
+private:
+	const Graph& graph;
+	size_t capacity; // 字节上限
+	std::list<std::shared_ptr<const ShortestPathTree>> lru; // 头部为最近使用
+	std::unordered_map<int, std::list<std::shared_ptr<const ShortestPathTree>>::iterator> index;
+	mutable std::mutex mtx;
+	Stats stat;
+};
+
+#endif // MYCPPPITFALLS_PATHCACHE_HPP
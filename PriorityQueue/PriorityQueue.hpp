@@ -11,38 +11,80 @@
 #include <vector>
 #include <queue>
 #include <set>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 
-struct Vertex {
-	int id;
-	int dist;
+/*
+距离类型的INF与饱和加法：int沿用原来的INF(0x3f3f3f3f)，与已有代码兼容；其他类型取最大值.
+sat_add在结果达到INF时停在INF，长路径、大权重时不会悄悄溢出成负数或小值.
+*/
+template<typename D>
+struct DistTraits {
+	static constexpr D inf() { return std::numeric_limits<D>::max(); }
+};
+
+template<>
+struct DistTraits<int> {
+	static constexpr int inf() { return INF; }
+};
+
+// 要求 a, b >= 0
+template<typename D, typename W>
+inline D sat_add(D a, W b) {
+	const D inf = DistTraits<D>::inf();
+	return static_cast<D>(b) >= inf || a >= inf - static_cast<D>(b) ? inf : static_cast<D>(a + static_cast<D>(b));
+}
+
+/*
+顶点编号与距离的存储类型可选，例如 uint32编号 + uint64距离；
+Vertex为原来的 int + int，8字节.
+*/
+template<typename Id, typename Dist>
+struct BasicVertex {
+	using id_type = Id;
+	using dist_type = Dist;
+
+	Id id;
+	Dist dist;
 
-	Vertex() : id(-1), dist(INF) {}
-	Vertex(int i, int d) : id(i), dist(d) {}
-	bool operator<(const Vertex& rhs) const {
+	BasicVertex() : id(static_cast<Id>(-1)), dist(DistTraits<Dist>::inf()) {}
+	BasicVertex(int i, Dist d) : id(static_cast<Id>(i)), dist(d) {}
+	bool operator<(const BasicVertex& rhs) const {
 		if (dist == rhs.dist) return id < rhs.id;
 		return dist < rhs.dist;
 	}
 };
 
+using Vertex = BasicVertex<int, int>;
+
 
 /*
-1. STLȶ priority_queue
-   priority_queueһvector/dequeڶѻ(make_heap)ʵ֣
-   ˸оSTLĬϴ󶥶е㷴...
+1. STL优先队列 priority_queue
+   priority_queue是一种容器适配器，可以适配vector/deque，基于堆化操作(make_heap)实现；
+   个人感觉STL默认大顶堆有点反人类...
+   比较器用函数对象而不是std::function，类型在编译期确定，每次堆比较都可以内联.
 */
-std::function<bool(const Vertex&, const Vertex&)> comp1 = [](const Vertex& lhs, const Vertex& rhs) {
-	if (lhs.dist == rhs.dist) return lhs.id > rhs.id;
-	return lhs.dist > rhs.dist;
+struct VertexGreater {
+	template<typename V>
+	bool operator()(const V& lhs, const V& rhs) const {
+		if (lhs.dist == rhs.dist) return lhs.id > rhs.id;
+		return lhs.dist > rhs.dist;
+	}
 };
-using PriorityQueue1 = std::priority_queue<Vertex, std::vector<Vertex>, decltype(comp1)>;
+template<typename V>
+using BasicPriorityQueue1 = std::priority_queue<V, std::vector<V>, VertexGreater>;
+using PriorityQueue1 = BasicPriorityQueue1<Vertex>;
 
 
 /*
-2. STL set
-   setںʵ֣ܺãԵ`֧ɾָԪصȶ`ʹã
-   ͬҪԪֱ֧ȽϺ.
+2. STL有序容器 set
+   set基于红黑树实现，查找性能好，可以当作`支持删除指定元素的优先队列`使用；
+   同样要求元素支持比较函数.
 */
 auto comp2 = [](auto& lhs, auto& rhs) {
 	if (lhs.dist == rhs.dist) return lhs.id < rhs.id;
@@ -50,78 +92,254 @@ auto comp2 = [](auto& lhs, auto& rhs) {
 };
 using PriorityQueue2 = std::set<Vertex, decltype(comp2)>;
 
-//using PriorityQueue2 = std::set<Vertex>; // Vertex`<`
+//using PriorityQueue2 = std::set<Vertex>; // Vertex重载`<`运算符
 
 
 /*
-3. Զ`ָָ֧Ԫصȶ`
+3. 自定义`支持更新指定元素的优先队列`
+   索引堆：额外维护 id->堆下标 的位置表pos，定位元素O(1)，
+   因此 contains/decrease_key/erase/update 均为O(logn)；要求 id ∈ [0, capacity).
+   元素类型V为BasicVertex，PriorityQueue3即 int + int 的版本.
 */
-class PriorityQueue3 {
+template<typename V>
+class BasicPriorityQueue3 {
 public:
-	PriorityQueue3(int c) : capacity(c), count(0) {
+	using Dist = typename V::dist_type;
+
+	BasicPriorityQueue3(int c) : capacity(c), count(0) {
 		nodes.resize(capacity + 1);
+		pos.resize(capacity, 0);
 	}
 
-	void add(Vertex&& data) {
-		if (count >= capacity) return;
+	void add(V&& data) {
+		if (count >= capacity || contains(data.id)) return;
 		++count;
 		nodes[count] = data;
+		pos[data.id] = count;
 		heapify_float(count);
 	}
 
-	Vertex poll() {
+	V poll() {
 		if (count == 0) return {};
-		Vertex top = nodes[1];
-		nodes[1] = nodes[count];
-		--count;
-		heapify_sink(1);
+		V top = nodes[1];
+		remove_at(1);
 		return top;
 	}
 
-	void update(Vertex&& data) {
-		int i = 1;
-		for (; i <= count; ++i) {
-			if (nodes[i].id == data.id) { break; }
-		}
+	void update(V&& data) {
+		if (!contains(data.id)) return;
+		int i = pos[data.id];
 		if (nodes[i].dist > data.dist) {
 			nodes[i].dist = data.dist;
-			heapify_float(i); // Сϸ
+			heapify_float(i); // 小的上浮
 		}
 		else {
 			nodes[i].dist = data.dist;
-			heapify_sink(i); // ³
+			heapify_sink(i); // 大的下沉
 		}
 	}
 
+	// 堆中元素只允许减小，仅需上浮
+	void decrease_key(int id, Dist dist) {
+		if (!contains(id)) return;
+		int i = pos[id];
+		if (dist >= nodes[i].dist) return;
+		nodes[i].dist = dist;
+		heapify_float(i);
+	}
+
+	void erase(int id) {
+		if (!contains(id)) return;
+		remove_at(pos[id]);
+	}
+
+	bool contains(int id) const { return pos[id] != 0; }
+
+	const V& top() const { return nodes[1]; }
+
+	// 只清理堆中剩余元素的位置表，O(size())，便于跨查询复用
+	void clear() {
+		for (int i = 1; i <= count; ++i) { pos[nodes[i].id] = 0; }
+		count = 0;
+	}
+
 	bool empty() const { return count == 0; }
 
 	int size() const { return count; }
 
 private:
-	// ϽѣСϸ
+	// 用堆尾元素填补下标i，再视大小上浮或下沉
+	void remove_at(int i) {
+		pos[nodes[i].id] = 0;
+		if (i != count) {
+			nodes[i] = nodes[count];
+			pos[nodes[i].id] = i;
+		}
+		--count;
+		if (i <= count) {
+			heapify_float(i);
+			heapify_sink(i);
+		}
+	}
+
+	void swap_node(int i, int j) {
+		std::swap(nodes[i], nodes[j]);
+		pos[nodes[i].id] = i;
+		pos[nodes[j].id] = j;
+	}
+
+	// 自下往上建堆，小的上浮
 	void heapify_float(int i) {
 		while (i / 2 > 0 && nodes[i].dist < nodes[i / 2].dist) {
-			std::swap(nodes[i], nodes[i / 2]);
+			swap_node(i, i / 2);
 			i /= 2;
 		}
 	}
 
-	// ¶ѻ³
+	// 自上往下堆化，大的下沉
 	void heapify_sink(int i) {
 		while (true) {
 			int min_pos = i;
 			if (i * 2 <= count && nodes[i * 2].dist < nodes[min_pos].dist) min_pos = i * 2;
 			if (i * 2 + 1 <= count && nodes[i * 2 + 1].dist < nodes[min_pos].dist) min_pos = i * 2 + 1;
 			if (min_pos == i) break;
-			std::swap(nodes[min_pos], nodes[i]);
+			swap_node(min_pos, i);
 			i = min_pos;
 		}
 	}
 
 private:
-	std::vector<Vertex> nodes;
+	std::vector<V> nodes;
+	std::vector<int> pos; // id -> 堆下标，0表示不在堆中
 	int capacity;
 	int count;
 };
 
+using PriorityQueue3 = BasicPriorityQueue3<Vertex>;
+
+/*
+4. 带句柄表的set `PrioritySet`
+   在PriorityQueue2基础上为每个id保存指向set节点的迭代器(句柄)，
+   更新时直接erase旧句柄，不再遍历整个set，每次松弛O(logn)；
+   set的迭代器在插入/删除其他元素时不会失效，end()作为`不在集合中`的哨兵.
+*/
+class PrioritySet {
+public:
+	PrioritySet(int c) : q(comp2), handles(c, q.end()), peak(0) {}
+	PrioritySet(const PrioritySet&) = delete; // 句柄绑定在q上，禁止拷贝
+	PrioritySet& operator=(const PrioritySet&) = delete;
+
+	// 不在集合中则插入，否则删除旧值后插入新值
+	void push(int id, int dist) {
+		if (contains(id)) { q.erase(handles[id]); }
+		handles[id] = q.emplace(id, dist).first;
+		if (q.size() > peak) { peak = q.size(); }
+	}
+
+	Vertex pop() {
+		if (q.empty()) return {};
+		Vertex top = *q.begin();
+		handles[top.id] = q.end();
+		q.erase(q.begin());
+		return top;
+	}
+
+	void erase(int id) {
+		if (!contains(id)) return;
+		q.erase(handles[id]);
+		handles[id] = q.end();
+	}
+
+	bool contains(int id) const { return handles[id] != q.end(); }
+
+	bool empty() const { return q.empty(); }
+
+	size_t size() const { return q.size(); }
+
+	size_t peak_size() const { return peak; }
+
+	// 估算峰值内存：红黑树节点(3个指针+颜色+元素) + 句柄表
+	size_t peak_bytes() const { return peak * node_bytes + handles.capacity() * sizeof(PriorityQueue2::iterator); }
+
+	static constexpr size_t node_bytes = 4 * sizeof(void*) + sizeof(Vertex);
+
+private:
+	PriorityQueue2 q;
+	std::vector<PriorityQueue2::iterator> handles; // id -> set节点
+	size_t peak;
+};
+
+/*
+6. 单调基数堆 `RadixHeap`
+   Dijkstra每次出队的dist单调不减，且边权为非负整数，可以不做比较排序：
+   按 key 与上次出队值last 的最高不同二进制位分桶(32位距离共33个桶，64位距离65个)，
+   出队时若0号桶为空，则取第一个非空桶的最小值作为新的last并把该桶重新分配到更低的桶，
+   每个元素最多下移位数次，push/pop均摊O(1)；不支持删除，旧值由调用方判断dist后丢弃.
+*/
+template<typename V>
+class BasicRadixHeap {
+public:
+	using Dist = typename V::dist_type;
+
+	BasicRadixHeap() : last(0), count(0) {}
+
+	// 要求 dist >= 最近一次出队的dist
+	void push(int id, Dist dist) {
+		buckets[bucket_of(static_cast<uint64_t>(dist))].emplace_back(id, dist);
+		++count;
+	}
+
+	V pop() {
+		if (count == 0) return {};
+		if (buckets[0].empty()) {
+			int i = 1;
+			while (buckets[i].empty()) { ++i; }
+			uint64_t new_last = static_cast<uint64_t>(buckets[i][0].dist);
+			for (auto& v : buckets[i]) {
+				if (static_cast<uint64_t>(v.dist) < new_last) new_last = static_cast<uint64_t>(v.dist);
+			}
+			last = new_last;
+			for (auto& v : buckets[i]) {
+				buckets[bucket_of(static_cast<uint64_t>(v.dist))].push_back(v);
+			}
+			buckets[i].clear();
+		}
+		V top = buckets[0].back();
+		buckets[0].pop_back();
+		--count;
+		return top;
+	}
+
+	bool empty() const { return count == 0; }
+
+	size_t size() const { return count; }
+
+private:
+	static constexpr int bits = static_cast<int>(sizeof(Dist) * 8);
+
+	// 0号桶存放等于last的元素，i号桶存放最高不同位为第i-1位的元素
+	int bucket_of(uint64_t key) const {
+		uint64_t diff = key ^ last;
+		if (diff == 0) return 0;
+#ifdef _MSC_VER
+		unsigned long msb;
+		if (diff >> 32) {
+			_BitScanReverse(&msb, static_cast<unsigned long>(diff >> 32));
+			return static_cast<int>(msb) + 33;
+		}
+		_BitScanReverse(&msb, static_cast<unsigned long>(diff));
+		return static_cast<int>(msb) + 1;
+#else
+		return 64 - __builtin_clzll(diff);
+#endif
+	}
+
+private:
+	std::vector<V> buckets[bits + 1];
+	uint64_t last;
+	size_t count;
+};
+
+using RadixHeap = BasicRadixHeap<Vertex>;
+
 #endif // MYCPPPITFALLS_PRIORITYQUEUE_HPP
@@ -0,0 +1,149 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_QUEUEPOLICY_HPP
+#define MYCPPPITFALLS_QUEUEPOLICY_HPP
+
+#include <ostream>
+#include "PriorityQueue.hpp"
+#include "DaryHeap.hpp"
+
+
+/*
+Dijkstra的队列策略：把各种优先队列包装成统一接口，供Graph::dijkstra<QueuePolicy>在编译期选择，
+比较函数与队列操作都可以内联.
+   Policy(int v_num);
+   bool push(int id, Dist dist); // 返回true表示对已在队列中的元素做了decrease-key
+   Vertex pop();
+   bool empty() const;
+   size_t size() const;
+不支持decrease-key的队列(priority_queue、基数堆)直接重复入队，出队时由Dijkstra跳过过期元素.
+带T后缀的策略以元素类型(BasicVertex)为参数，可用于其他宽度的距离；set与D叉堆只支持int.
+*/
+template<typename V>
+struct STLQueuePolicyT {
+	BasicPriorityQueue1<V> q;
+
+	STLQueuePolicyT(int) {}
+	bool push(int id, typename V::dist_type dist) { q.emplace(id, dist); return false; }
+	V pop() { V top = q.top(); q.pop(); return top; }
+	bool empty() const { return q.empty(); }
+	size_t size() const { return q.size(); }
+};
+
+using STLQueuePolicy = STLQueuePolicyT<Vertex>;
+
+// 保持原始写法：遍历整个set找到旧值再删除，O(n)
+struct STLSetPolicy {
+	PriorityQueue2 q;
+
+	STLSetPolicy(int) : q(comp2) {}
+	bool push(int id, int dist) {
+		bool found = false;
+		for (auto iter = q.begin(); iter != q.end(); ++iter) {
+			if (iter->id == id) { // 如果在队列中则删除旧值
+				q.erase(iter);
+				found = true;
+				break;
+			}
+		}
+		q.emplace(id, dist);
+		return found;
+	}
+	Vertex pop() { Vertex top = *q.begin(); q.erase(q.begin()); return top; }
+	bool empty() const { return q.empty(); }
+	size_t size() const { return q.size(); }
+};
+
+struct HandleSetPolicy {
+	PrioritySet q;
+
+	HandleSetPolicy(int v_num) : q(v_num) {}
+	bool push(int id, int dist) {
+		bool found = q.contains(id);
+		q.push(id, dist); // 通过句柄删除旧值，新值入队
+		return found;
+	}
+	Vertex pop() { return q.pop(); }
+	bool empty() const { return q.empty(); }
+	size_t size() const { return q.size(); }
+};
+
+template<typename Heap>
+struct IndexedHeapPolicyT {
+	Heap q;
+
+	IndexedHeapPolicyT(int v_num) : q(v_num) {}
+	template<typename Dist>
+	bool push(int id, Dist dist) {
+		if (q.contains(id)) {
+			q.decrease_key(id, dist); // 如果在队列中则更新dist值
+			return true;
+		}
+		q.add({ id, dist });
+		return false;
+	}
+	auto pop() -> decltype(q.poll()) { return q.poll(); }
+	bool empty() const { return q.empty(); }
+	size_t size() const { return static_cast<size_t>(q.size()); }
+};
+
+using IndexedHeapPolicy = IndexedHeapPolicyT<PriorityQueue3>;
+
+template<int D>
+using DaryHeapPolicy = IndexedHeapPolicyT<DaryHeap<D>>;
+
+template<typename V>
+struct RadixHeapPolicyT {
+	BasicRadixHeap<V> q;
+
+	RadixHeapPolicyT(int) {}
+	bool push(int id, typename V::dist_type dist) { q.push(id, dist); return false; }
+	V pop() { return q.pop(); }
+	bool empty() const { return q.empty(); }
+	size_t size() const { return q.size(); }
+};
+
+using RadixHeapPolicy = RadixHeapPolicyT<Vertex>;
+
+
+/*
+Dijkstra操作计数：DijkstraStats记录各类操作次数，
+NoStats的成员函数均为空，关闭统计时被编译器完全消除.
+*/
+struct NoStats {
+	void on_push() {}
+	void on_pop() {}
+	void on_stale_pop() {}
+	void on_decrease_key() {}
+	void on_relax() {}
+	void on_queue_size(size_t) {}
+	void on_finish(size_t) {}
+};
+
+struct DijkstraStats {
+	size_t pushes = 0;
+	size_t pops = 0;
+	size_t stale_pops = 0;    // 出队时dist已过期的元素
+	size_t decrease_keys = 0;
+	size_t edges_relaxed = 0; // 扫描过的边数
+	size_t peak_size = 0;     // 队列峰值元素数
+	size_t remaining = 0;     // 结束时队列剩余元素数
+
+	void on_push() { ++pushes; }
+	void on_pop() { ++pops; }
+	void on_stale_pop() { ++stale_pops; }
+	void on_decrease_key() { ++decrease_keys; }
+	void on_relax() { ++edges_relaxed; }
+	void on_queue_size(size_t n) { if (n > peak_size) peak_size = n; }
+	void on_finish(size_t n) { remaining = n; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const DijkstraStats& st) {
+	return os << "push: " << st.pushes << ", pop: " << st.pops << ", 过期出队: " << st.stale_pops
+		<< ", decrease-key: " << st.decrease_keys << ", 松弛边数: " << st.edges_relaxed;
+}
+
+#endif // MYCPPPITFALLS_QUEUEPOLICY_HPP
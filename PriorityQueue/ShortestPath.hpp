@@ -7,131 +7,803 @@
 #define MYCPPPITFALLS_SHORTESTPATH_HPP
 
 #include <iostream>
-#include "PriorityQueue.hpp"
+#include <utility>
+#include <memory>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "QueuePolicy.hpp"
+#include "ThreadPool.hpp"
+#include "MappedFile.hpp"
 
 using std::vector;
 using std::cout;
 using std::endl;
 
-struct Edge {
-	int sid;
-	int tid;
-	int w;
+/*
+编号与权重的存储宽度由模板参数决定，Edge、CsrAdj、Graph等为原来 int 的版本.
+对外接口中的顶点编号与顶点数仍为int，Id只影响存储，例如 uint32编号 + uint16权重 + uint64距离.
+*/
+template<typename Id, typename W>
+struct BasicEdge {
+	Id sid;
+	Id tid;
+	W w;
 
-	Edge(int s, int t, int w) : sid(s), tid(t), w(w) {}
+	BasicEdge(int s, int t, W w) : sid(static_cast<Id>(s)), tid(static_cast<Id>(t)), w(w) {}
 };
 
-using AdjList = vector<vector<Edge>>;
+using Edge = BasicEdge<int, int>;
 
-class Graph {
+/*
+压缩稀疏行(CSR)邻接表：顶点u的出边为下标区间[offsets[u], offsets[u+1])，
+终点和权重分两个连续数组存放，松弛时顺序扫描，无需每个顶点单独分配内存.
+三个数组通过指针访问，既可以指向自有存储，也可以直接指向内存映射的快照文件(零拷贝)；
+映射的数据只读，修改前由detach()复制为自有存储(写时复制).
+*/
+template<typename Id, typename W>
+struct BasicCsrAdj {
+	using id_type = Id;
+	using weight_type = W;
+
+	const int* offsets; // 大小v_num+1
+	const Id* targets;
+	const W* weights;
+
+	BasicCsrAdj() : offsets(nullptr), targets(nullptr), weights(nullptr), v_num(0), e_num(0) {}
+	BasicCsrAdj(const BasicCsrAdj& other) : BasicCsrAdj() { *this = other; }
+	BasicCsrAdj(BasicCsrAdj&&) = default; // vector移动后缓冲区地址不变，指针仍然有效
+	BasicCsrAdj& operator=(BasicCsrAdj&&) = default;
+
+	BasicCsrAdj& operator=(const BasicCsrAdj& other) {
+		if (this == &other) return *this;
+		v_num = other.v_num;
+		e_num = other.e_num;
+		offset_buf = other.offset_buf;
+		target_buf = other.target_buf;
+		weight_buf = other.weight_buf;
+		if (other.owned()) {
+			attach();
+		}
+		else { // 共享同一份映射
+			offsets = other.offsets;
+			targets = other.targets;
+			weights = other.weights;
+		}
+		return *this;
+	}
+
+	int begin(int u) const { return offsets[u]; }
+	int end(int u) const { return offsets[u + 1]; }
+	int vertex_num() const { return v_num; }
+	int edge_num() const { return e_num; }
+
+	// 数组是否为自有存储，false表示指向外部(映射)内存
+	bool owned() const { return offsets == offset_buf.data(); }
+
+	// 按起点计数排序，同一起点的边保持add_edge的顺序；reverse为true时按终点分组构建反向图
+	static BasicCsrAdj build(int v_num, const vector<BasicEdge<Id, W>>& edges, bool reverse = false) {
+		BasicCsrAdj csr;
+		csr.v_num = v_num;
+		csr.e_num = static_cast<int>(edges.size());
+		vector<int>& offsets = csr.offset_buf;
+		offsets.assign(v_num + 1, 0);
+		for (auto& e : edges) { ++offsets[(reverse ? e.tid : e.sid) + 1]; }
+		for (int u = 0; u < v_num; ++u) { offsets[u + 1] += offsets[u]; }
+		csr.target_buf.resize(edges.size());
+		csr.weight_buf.resize(edges.size());
+		vector<int> cursor(offsets.begin(), offsets.end() - 1);
+		for (auto& e : edges) {
+			int i = cursor[reverse ? e.tid : e.sid]++;
+			csr.target_buf[i] = reverse ? e.sid : e.tid;
+			csr.weight_buf[i] = e.w;
+		}
+		csr.attach();
+		return csr;
+	}
+
+	// 不复制地引用外部数组，调用者保证其生命周期
+	static BasicCsrAdj view(int v_num, int e_num, const int* offsets, const Id* targets, const W* weights) {
+		BasicCsrAdj csr;
+		csr.v_num = v_num;
+		csr.e_num = e_num;
+		csr.offsets = offsets;
+		csr.targets = targets;
+		csr.weights = weights;
+		return csr;
+	}
+
+	// 把外部数组复制为自有存储，之后才能修改
+	void detach() {
+		if (owned()) return;
+		offset_buf.assign(offsets, offsets + v_num + 1);
+		target_buf.assign(targets, targets + e_num);
+		weight_buf.assign(weights, weights + e_num);
+		attach();
+	}
+
+	W* mutable_weights() {
+		detach();
+		return weight_buf.data();
+	}
+
+	// 删除行u中终点为t的元素，后续行的offsets前移；返回是否删除了元素
+	bool erase(int u, int t) {
+		if (std::find(targets + begin(u), targets + end(u), static_cast<Id>(t)) == targets + end(u)) return false;
+		detach();
+		int k = begin(u);
+		for (int i = begin(u); i < end(u); ++i) {
+			if (target_buf[i] == static_cast<Id>(t)) continue;
+			target_buf[k] = target_buf[i];
+			weight_buf[k] = weight_buf[i];
+			++k;
+		}
+		int removed = end(u) - k;
+		target_buf.erase(target_buf.begin() + k, target_buf.begin() + end(u));
+		weight_buf.erase(weight_buf.begin() + k, weight_buf.begin() + end(u));
+		for (int v = u + 1; v <= v_num; ++v) { offset_buf[v] -= removed; }
+		e_num -= removed;
+		attach();
+		return true;
+	}
+
+private:
+	void attach() {
+		offsets = offset_buf.data();
+		targets = target_buf.data();
+		weights = weight_buf.data();
+	}
+
+private:
+	int v_num;
+	int e_num;
+	vector<int> offset_buf; // 自有存储，引用外部数组时为空
+	vector<Id> target_buf;
+	vector<W> weight_buf;
+};
+
+using CsrAdj = BasicCsrAdj<int, int>;
+
+// 在邻接表g上求s到所有顶点的最短距离(不可达为INF)，供各种预处理使用；在反向图上即为所有顶点到s的距离
+template<typename D = int, typename Id, typename W>
+inline vector<D> single_source_dist(const BasicCsrAdj<Id, W>& g, int s) {
+	int n = g.vertex_num();
+	vector<D> dist(n, DistTraits<D>::inf());
+	dist[s] = 0;
+	BasicPriorityQueue3<BasicVertex<Id, D>> q(n);
+	q.add({ s, 0 });
+	while (!q.empty()) {
+		auto curr = q.poll();
+		for (int i = g.begin(curr.id); i < g.end(curr.id); ++i) {
+			int v = static_cast<int>(g.targets[i]);
+			D nd = sat_add(curr.dist, g.weights[i]);
+			if (nd < dist[v]) {
+				dist[v] = nd;
+				if (q.contains(v)) {
+					q.decrease_key(v, dist[v]);
+				}
+				else {
+					q.add({ v, dist[v] });
+				}
+			}
+		}
+	}
+	return dist;
+}
+
+/*
+可复用的查询工作区：dist/predecessor按时间戳stamp惰性失效，
+reset()只需令gen加一并清空堆中剩余元素，代价与上次查询访问的顶点数成正比，而非O(V).
+每个线程持有一个工作区，Graph本身只读，可在线程间共享.
+*/
+template<typename Id, typename D>
+class BasicQueryWorkspace {
 public:
-	Graph(int v) : v_num(v), dist(v_num, INF), adj(v_num) {}
+	using Queue = BasicPriorityQueue3<BasicVertex<Id, D>>;
 
-	void add_edge(int s, int t, int w) { adj[s].emplace_back(s, t, w); }
+	BasicQueryWorkspace(int v_num) : dist(v_num), predecessor(v_num), stamp(v_num, 0), gen(0), q(v_num), settled(0) {}
 
-	void dijkstraWithSTLQueue(int s, int t) {
-		vector<int> predecessor(v_num);
-		dist.clear();
-		dist.resize(v_num, INF);
-		dist[s] = 0;
-		PriorityQueue1 q(comp1); // С
-		q.emplace(s, 0);
+	void reset() {
+		q.clear();
+		settled = 0;
+		if (++gen == 0) { // 时间戳回绕，整体清零一次
+			std::fill(stamp.begin(), stamp.end(), 0u);
+			gen = 1;
+		}
+	}
+
+	D get_dist(int v) const { return stamp[v] == gen ? dist[v] : DistTraits<D>::inf(); }
+
+	void set_dist(int v, D d, int pre) {
+		stamp[v] = gen;
+		dist[v] = d;
+		predecessor[v] = pre;
+	}
+
+	// s到t的路径，不可达时为空
+	vector<int> path(int s, int t) const {
+		vector<int> p;
+		if (get_dist(t) == DistTraits<D>::inf()) return p;
+		for (int v = t; v != s; v = predecessor[v]) { p.push_back(v); }
+		p.push_back(s);
+		std::reverse(p.begin(), p.end());
+		return p;
+	}
+
+	Queue& queue() { return q; }
+
+	int settled_num() const { return settled; }
+
+	void count_settled() { ++settled; }
+
+private:
+	vector<D> dist;
+	vector<int> predecessor;
+	vector<unsigned> stamp; // stamp[v] != gen 表示v在本次查询中未被访问
+	unsigned gen;
+	Queue q;
+	int settled;
+};
+
+using QueryWorkspace = BasicQueryWorkspace<int, int>;
+
+// 双向查询的工作区：正向(从s)、反向(从t)各一个，以及上一次查询的相遇点
+template<typename Id, typename D>
+struct BasicBidirectionalWorkspace {
+	BasicQueryWorkspace<Id, D> fw;
+	BasicQueryWorkspace<Id, D> bw;
+	int meet;
+
+	BasicBidirectionalWorkspace(int v_num) : fw(v_num), bw(v_num), meet(-1) {}
+
+	// 两侧出队的顶点数之和
+	int settled_num() const { return fw.settled_num() + bw.settled_num(); }
+
+	// 上一次查询的路径 s -> meet -> t，不可达时为空
+	vector<int> path(int s, int t) const {
+		if (meet == -1) return {};
+		vector<int> p = fw.path(s, meet);
+		vector<int> back = bw.path(t, meet); // t ... meet，原图方向为 meet -> t
+		p.insert(p.end(), back.rbegin() + 1, back.rend());
+		return p;
+	}
+};
+
+using BidirectionalWorkspace = BasicBidirectionalWorkspace<int, int>;
+
+/*
+多对多距离表：rows个起点 × cols个终点，按行连续存放，data[i*cols+j]为sources[i]到targets[j]的距离，
+不可达为INF. 同一起点的一行连续，方便对整行做向量化的min-plus等后处理.
+*/
+template<typename D>
+struct BasicDistanceTable {
+	int rows;
+	int cols;
+	vector<D> data;
+
+	BasicDistanceTable(int r, int c) : rows(r), cols(c), data(static_cast<size_t>(r) * c, DistTraits<D>::inf()) {}
+
+	D at(int i, int j) const { return data[static_cast<size_t>(i) * cols + j]; }
+
+	const D* row(int i) const { return data.data() + static_cast<size_t>(i) * cols; }
+};
+
+using DistanceTable = BasicDistanceTable<int>;
+
+/*
+Id：顶点编号的存储类型，W：边权类型，D：距离类型(须能容纳最长路径)，均为整数.
+松弛使用sat_add，距离超过D的范围时停在INF(视为不可达)，不会回绕.
+Graph = BasicGraph<int, int, int>，与原来的实现完全相同.
+*/
+template<typename Id, typename W, typename D>
+class BasicGraph {
+public:
+	using EdgeType = BasicEdge<Id, W>;
+	using AdjType = BasicCsrAdj<Id, W>;
+	using VertexType = BasicVertex<Id, D>;
+	using Workspace = BasicQueryWorkspace<Id, D>;
+	using BidirectionalWorkspace = BasicBidirectionalWorkspace<Id, D>;
+	using Table = BasicDistanceTable<D>;
+
+	BasicGraph(int v) : v_num(v), adj(AdjType::build(v, {})), radj(adj) {}
+
+	// 边先缓存在edges中，调用freeze()后才对查询可见
+	void add_edge(int s, int t, W w) { edges.emplace_back(s, t, w); }
+
+	// 将缓存的边并入CSR并释放缓存，可在追加边后重复调用
+	void freeze() {
+		if (edges.empty()) return;
+		if (adj.edge_num() > 0) {
+			vector<EdgeType> all;
+			all.reserve(adj.edge_num() + edges.size());
+			for (int u = 0; u < v_num; ++u) {
+				for (int i = adj.begin(u); i < adj.end(u); ++i) {
+					all.emplace_back(u, adj.targets[i], adj.weights[i]);
+				}
+			}
+			all.insert(all.end(), edges.begin(), edges.end());
+			edges.swap(all);
+		}
+		adj = AdjType::build(v_num, edges);
+		radj = AdjType::build(v_num, edges, true);
+		vector<EdgeType>().swap(edges);
+		mapping.reset(); // 不再引用快照
+	}
+
+	/*
+	动态修改：update_edge把所有s->t边的权重改为w，remove_edge删除所有s->t边，
+	正反两张CSR同步修改，缓存中尚未freeze()的边也一并处理；不存在该边时返回false.
+	修改权重原地完成，删除需要移动其后的元素，代价O(V+E)，批量删除时尽量合并.
+	ALT、CH、DeltaStepping等基于旧图的预处理结果不会自动更新，修改后需重新预处理.
+	*/
+	bool update_edge(int s, int t, W w) {
+		bool found = false;
+		for (int i = adj.begin(s); i < adj.end(s); ++i) {
+			if (static_cast<int>(adj.targets[i]) == t) { adj.mutable_weights()[i] = w; found = true; }
+		}
+		for (int i = radj.begin(t); i < radj.end(t); ++i) {
+			if (static_cast<int>(radj.targets[i]) == s) radj.mutable_weights()[i] = w;
+		}
+		for (auto& e : edges) {
+			if (static_cast<int>(e.sid) == s && static_cast<int>(e.tid) == t) { e.w = w; found = true; }
+		}
+		return found;
+	}
+
+	bool remove_edge(int s, int t) {
+		size_t buffered = edges.size();
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const EdgeType& e) { return static_cast<int>(e.sid) == s && static_cast<int>(e.tid) == t; }), edges.end());
+		bool found = adj.erase(s, t);
+		radj.erase(t, s);
+		return found || edges.size() != buffered;
+	}
+
+	// s->t的最小权重，不存在时为INF
+	D edge_weight(int s, int t) const {
+		D w = DistTraits<D>::inf();
+		for (int i = adj.begin(s); i < adj.end(s); ++i) {
+			if (static_cast<int>(adj.targets[i]) == t) w = std::min(w, static_cast<D>(adj.weights[i]));
+		}
+		return w;
+	}
+
+	/*
+	二进制快照：写一次，之后用load_snapshot()内存映射打开，查询直接读取映射的页面，无需解析和复制.
+	布局(本机字节序)：SnapshotHeader | adj.offsets | adj.targets | adj.weights | radj.offsets | radj.targets | radj.weights，
+	每段起始按64字节对齐，头部记录各段的偏移与FNV-1a校验和，头部自身也有校验和；
+	offsets为int32，targets/weights按Id/W的宽度存放，宽度记录在头部，打开时必须与当前类型一致.
+	只保存freeze()后的CSR，缓存中的边不写入.
+	*/
+	bool save_snapshot(const std::string& path) const {
+		const AdjType* parts[2] = { &adj, &radj };
+		SnapshotHeader head = {};
+		std::memcpy(head.magic, snapshot_magic(), 4);
+		head.version = snapshot_version;
+		head.v_num = static_cast<uint32_t>(v_num);
+		head.e_num = static_cast<uint32_t>(adj.edge_num());
+		head.id_bytes = static_cast<uint8_t>(sizeof(Id));
+		head.weight_bytes = static_cast<uint8_t>(sizeof(W));
+		uint64_t pos = align_up(sizeof(SnapshotHeader));
+		for (int k = 0; k < 6; ++k) {
+			const void* p = section_data(*parts[k / 3], k % 3);
+			size_t bytes = section_bytes(k % 3);
+			head.section_offset[k] = pos;
+			head.section_checksum[k] = fnv1a(p, bytes);
+			pos = align_up(pos + bytes);
+		}
+		head.header_checksum = fnv1a(&head, offsetof(SnapshotHeader, header_checksum));
+		std::ofstream out(path, std::ios::binary);
+		if (!out) return false;
+		out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+		uint64_t written = sizeof(head);
+		for (int k = 0; k < 6; ++k) {
+			static const char zeros[snapshot_align] = {};
+			out.write(zeros, static_cast<std::streamsize>(head.section_offset[k] - written));
+			size_t bytes = section_bytes(k % 3);
+			out.write(reinterpret_cast<const char*>(section_data(*parts[k / 3], k % 3)), static_cast<std::streamsize>(bytes));
+			written = head.section_offset[k] + bytes;
+		}
+		return static_cast<bool>(out);
+	}
+
+	/*
+	映射打开快照，替换当前图. 总是检查头部、各段边界与CSR结构(offsets单调不减、终点编号在[0, n)内、边权非负)，
+	代价O(V+E)，保证截断或损坏的文件不会导致越界访问；verify为true时再校验各段的FNV-1a校验和. 失败时保持原图不变.
+	之后的update_edge/remove_edge会先把CSR复制为自有存储，不会写回文件.
+	*/
+	bool load_snapshot(const std::string& path, bool verify = false) {
+		std::shared_ptr<MappedFile> file(new MappedFile());
+		if (!file->open(path) || file->size() < sizeof(SnapshotHeader)) return false;
+		SnapshotHeader head;
+		std::memcpy(&head, file->data(), sizeof(head));
+		if (std::memcmp(head.magic, snapshot_magic(), 4) != 0 || head.version != snapshot_version) return false;
+		if (head.header_checksum != fnv1a(&head, offsetof(SnapshotHeader, header_checksum))) return false;
+		if (head.id_bytes != sizeof(Id) || head.weight_bytes != sizeof(W)) return false;
+		if (head.v_num > static_cast<uint32_t>(INT32_MAX) || head.e_num > static_cast<uint32_t>(INT32_MAX)) return false;
+		int n = static_cast<int>(head.v_num), m = static_cast<int>(head.e_num);
+		const char* p[6];
+		for (int k = 0; k < 6; ++k) {
+			uint64_t bytes = section_bytes(k % 3, n, m);
+			if (head.section_offset[k] % snapshot_align != 0 || head.section_offset[k] > file->size()
+				|| bytes > file->size() - head.section_offset[k]) return false;
+			p[k] = file->data() + head.section_offset[k];
+			if (verify && head.section_checksum[k] != fnv1a(p[k], static_cast<size_t>(bytes))) return false;
+		}
+		const int* fo = reinterpret_cast<const int*>(p[0]);
+		const int* bo = reinterpret_cast<const int*>(p[3]);
+		if (!valid_csr(n, m, fo, reinterpret_cast<const Id*>(p[1]), reinterpret_cast<const W*>(p[2]))
+			|| !valid_csr(n, m, bo, reinterpret_cast<const Id*>(p[4]), reinterpret_cast<const W*>(p[5]))) return false;
+		v_num = n;
+		vector<EdgeType>().swap(edges);
+		adj = AdjType::view(n, m, fo, reinterpret_cast<const Id*>(p[1]), reinterpret_cast<const W*>(p[2]));
+		radj = AdjType::view(n, m, bo, reinterpret_cast<const Id*>(p[4]), reinterpret_cast<const W*>(p[5]));
+		mapping = file;
+		return true;
+	}
+
+	int vertex_num() const { return v_num; }
+
+	int edge_num() const { return adj.edge_num(); }
+
+	const AdjType& adjacency() const { return adj; }
+
+	const AdjType& reverse_adjacency() const { return radj; }
+
+	// freeze()后正向CSR的FNV-1a校验和，用于确认预处理文件(如ALT)与当前图一致
+	uint64_t checksum() const {
+		uint64_t h = fnv1a(adj.offsets, section_bytes(0));
+		h = fnv1a(adj.targets, section_bytes(1), h);
+		return fnv1a(adj.weights, section_bytes(2), h);
+	}
+
+	// 使用工作区的查询，返回s到t的最短距离(不可达为INF)，路径通过ws.path(s, t)获取；t=-1时求单源全部最短路
+	D query(int s, int t, Workspace& ws) const {
+		ws.reset();
+		ws.set_dist(s, 0, s);
+		auto& q = ws.queue();
+		q.add({ s, 0 });
 		while (!q.empty()) {
-			auto curr = q.top();
-			q.pop();
-			if (curr.id == t) { break; } // ·
-			for (auto& e : adj[curr.id]) {
-				if (curr.dist + e.w < dist[e.tid]) {
-					predecessor[e.tid] = curr.id; // ¼ǰڵ
-					dist[e.tid] = curr.dist + e.w;
-					q.emplace(e.tid, dist[e.tid]);
+			auto curr = q.poll();
+			ws.count_settled();
+			if (static_cast<int>(curr.id) == t) { break; } // 最短路径！
+			for (int i = adj.begin(curr.id); i < adj.end(curr.id); ++i) {
+				int v = static_cast<int>(adj.targets[i]);
+				D nd = sat_add(curr.dist, adj.weights[i]);
+				if (nd < ws.get_dist(v)) {
+					ws.set_dist(v, nd, curr.id);
+					if (q.contains(v)) {
+						q.decrease_key(v, nd);
+					}
+					else {
+						q.add({ v, nd });
+					}
 				}
 			}
 		}
-		print_path(s, t, predecessor);
-		print_dist(s, t, dist);
-		cout << "priority_queueʣԪ: " << q.size() << endl;
+		return t < 0 ? DistTraits<D>::inf() : ws.get_dist(t);
 	}
 
-	void dijkstraWithSTLSet(int s, int t) {
-		vector<int> predecessor(v_num);
-		dist.clear();
-		dist.resize(v_num, INF);
+	// 批量点对点查询，在线程池上并行执行，每个线程一个工作区
+	vector<D> batch_query(const vector<std::pair<int, int>>& queries, ThreadPool& pool) const {
+		vector<D> res(queries.size(), DistTraits<D>::inf());
+		vector<std::unique_ptr<Workspace>> workspaces(pool.size());
+		pool.parallel_for(queries.size(), [&](size_t i, int tid) {
+			if (!workspaces[tid]) { workspaces[tid].reset(new Workspace(v_num)); }
+			res[i] = query(queries[i].first, queries[i].second, *workspaces[tid]);
+		}, 16);
+		return res;
+	}
+
+	/*
+	多对多距离表：每个起点做一次Dijkstra，全部(去重后的)终点出队即停止，起点之间在线程池上并行，
+	每个线程一个工作区，结果直接写入DistanceTable中该起点的一行.
+	*/
+	Table distance_table(const vector<int>& sources, const vector<int>& targets, ThreadPool& pool) const {
+		Table table(static_cast<int>(sources.size()), static_cast<int>(targets.size()));
+		vector<char> is_target(v_num, 0);
+		int target_num = 0;
+		for (int t : targets) {
+			if (!is_target[t]) { is_target[t] = 1; ++target_num; }
+		}
+		if (target_num == 0) return table;
+		vector<std::unique_ptr<Workspace>> workspaces(pool.size());
+		pool.parallel_for(sources.size(), [&](size_t i, int tid) {
+			if (!workspaces[tid]) { workspaces[tid].reset(new Workspace(v_num)); }
+			Workspace& ws = *workspaces[tid];
+			ws.reset();
+			ws.set_dist(sources[i], 0, sources[i]);
+			auto& q = ws.queue();
+			q.add({ sources[i], 0 });
+			int remaining = target_num;
+			while (!q.empty()) {
+				auto curr = q.poll();
+				if (is_target[curr.id] && --remaining == 0) { break; } // 所有终点都已确定
+				for (int k = adj.begin(curr.id); k < adj.end(curr.id); ++k) {
+					int v = static_cast<int>(adj.targets[k]);
+					D nd = sat_add(curr.dist, adj.weights[k]);
+					if (nd < ws.get_dist(v)) {
+						ws.set_dist(v, nd, curr.id);
+						if (q.contains(v)) {
+							q.decrease_key(v, nd);
+						}
+						else {
+							q.add({ v, nd });
+						}
+					}
+				}
+			}
+			D* row = table.data.data() + i * targets.size();
+			for (size_t j = 0; j < targets.size(); ++j) { row[j] = ws.get_dist(targets[j]); }
+		});
+		return table;
+	}
+
+	/*
+	以队列策略为模板参数的Dijkstra，各dijkstraWith*只是选择不同的QueuePolicy；
+	stats为DijkstraStats时统计各类操作次数，默认的NoStats不产生任何开销.
+	返回s到t的最短距离，t=-1时求单源全部最短路. 非int的距离类型需要带T后缀的策略，如IndexedHeapPolicyT<Workspace::Queue>.
+	*/
+	template<typename QueuePolicy, typename Stats = NoStats>
+	D dijkstra(int s, int t, vector<D>& dist, vector<int>& predecessor, Stats&& stats = Stats()) const {
+		dist.assign(v_num, DistTraits<D>::inf()); // 距起点的最短路径
+		predecessor.assign(v_num, -1);
 		dist[s] = 0;
-		PriorityQueue2 q(comp2);
-		q.emplace(s, 0);
+		predecessor[s] = s;
+		QueuePolicy q(v_num);
+		q.push(s, static_cast<D>(0));
+		stats.on_push();
 		while (!q.empty()) {
-			auto curr = *q.begin(); // ǰ·Ӳɾ
-			q.erase(q.begin());
-			if (curr.id == t) { break; } // ·
-			for (auto& e : adj[curr.id]) {
-				if (curr.dist + e.w < dist[e.tid]) {
-					predecessor[e.tid] = curr.id; // ¼ǰڵ
-					dist[e.tid] = curr.dist + e.w;
-					for (auto iter = q.begin(); iter != q.end(); ++iter) {
-						if (iter->id == e.tid) { // ڶɾֵ
-							q.erase(iter);
-							break;
-						}
+			auto curr = q.pop();
+			stats.on_pop();
+			if (curr.dist > dist[curr.id]) { // 不支持decrease-key的队列中的过期元素
+				stats.on_stale_pop();
+				continue;
+			}
+			if (static_cast<int>(curr.id) == t) { break; } // 最短路径！
+			for (int i = adj.begin(curr.id); i < adj.end(curr.id); ++i) {
+				int v = static_cast<int>(adj.targets[i]);
+				D nd = sat_add(curr.dist, adj.weights[i]);
+				stats.on_relax();
+				if (nd < dist[v]) {
+					predecessor[v] = curr.id; // 记录前驱节点
+					dist[v] = nd;
+					if (q.push(v, dist[v])) {
+						stats.on_decrease_key();
+					}
+					else {
+						stats.on_push();
+						stats.on_queue_size(q.size());
 					}
-					q.emplace(e.tid, dist[e.tid]); // ֵ
 				}
 			}
 		}
+		stats.on_finish(q.size());
+		return t < 0 ? DistTraits<D>::inf() : dist[t];
+	}
+
+	void dijkstraWithSTLQueue(int s, int t) const {
+		vector<D> dist;
+		vector<int> predecessor;
+		DijkstraStats stats;
+		dijkstra<STLQueuePolicy>(s, t, dist, predecessor, stats);
 		print_path(s, t, predecessor);
 		print_dist(s, t, dist);
-		cout << "setʣԪ: " << q.size() << endl;
+		cout << "priority_queue队列中剩余元素: " << stats.remaining << endl;
+		cout << stats << endl;
 	}
 
-	void dijkstraWithCusQueue(int s, int t) {
-		vector<int> predecessor(v_num);
-		dist.clear();
-		dist.resize(v_num, INF);
-		dist[s] = 0;
-		PriorityQueue3 q(v_num);
-		q.add({ s, 0 });
-		vector<bool> visited(v_num, false);
-		visited[s] = true; // Ƿڶ
-		while (!q.empty()) {
+	void dijkstraWithSTLSet(int s, int t) const {
+		vector<D> dist;
+		vector<int> predecessor;
+		DijkstraStats stats;
+		dijkstra<STLSetPolicy>(s, t, dist, predecessor, stats);
+		print_path(s, t, predecessor);
+		print_dist(s, t, dist);
+		cout << "set队列中剩余元素: " << stats.remaining << endl;
+		cout << "set峰值元素: " << stats.peak_size << ", 估计内存: " << stats.peak_size * PrioritySet::node_bytes << " bytes" << endl;
+		cout << stats << endl;
+	}
+
+	void dijkstraWithHandleSet(int s, int t) const {
+		vector<D> dist;
+		vector<int> predecessor;
+		DijkstraStats stats;
+		dijkstra<HandleSetPolicy>(s, t, dist, predecessor, stats);
+		print_path(s, t, predecessor);
+		print_dist(s, t, dist);
+		size_t bytes = stats.peak_size * PrioritySet::node_bytes + v_num * sizeof(PriorityQueue2::iterator);
+		cout << "句柄set队列中剩余元素: " << stats.remaining << endl;
+		cout << "句柄set峰值元素: " << stats.peak_size << ", 估计内存(含句柄表): " << bytes << " bytes" << endl;
+		cout << stats << endl;
+	}
+
+	void dijkstraWithCusQueue(int s, int t) const {
+		vector<D> dist;
+		vector<int> predecessor;
+		DijkstraStats stats;
+		dijkstra<IndexedHeapPolicy>(s, t, dist, predecessor, stats);
+		print_path(s, t, predecessor);
+		print_dist(s, t, dist);
+		cout << "自定义优先队列中剩余元素: " << stats.remaining << endl;
+		cout << stats << endl;
+	}
+
+	/*
+	双向Dijkstra：正向从s、反向(在radj上)从t交替扩展队首较小的一侧，
+	每次松弛到对侧已到达的顶点时更新最短路上界mu和相遇点meet；
+	当 正向队首 + 反向队首 >= mu 时，不可能再有更短的路径，停止.
+	返回s到t的最短距离(不可达为INF)，路径通过ws.path(s, t)获取，ws.settled_num()为两侧出队的顶点数.
+	*/
+	D bidirectional_query(int s, int t, BidirectionalWorkspace& bws) const {
+		const D inf = DistTraits<D>::inf();
+		Workspace& fw = bws.fw;
+		Workspace& bw = bws.bw;
+		fw.reset();
+		bw.reset();
+		fw.set_dist(s, 0, s);
+		bw.set_dist(t, 0, t);
+		auto& fq = fw.queue();
+		auto& bq = bw.queue();
+		fq.add({ s, 0 });
+		bq.add({ t, 0 });
+		D mu = s == t ? 0 : inf;
+		bws.meet = s == t ? s : -1;
+		while (!fq.empty() && !bq.empty()) {
+			if (sat_add(fq.top().dist, bq.top().dist) >= mu) { break; } // 停止条件
+			bool forward = fq.top().dist <= bq.top().dist;
+			Workspace& ws = forward ? fw : bw;
+			const Workspace& other = forward ? bw : fw;
+			const AdjType& g = forward ? adj : radj;
+			auto& q = ws.queue();
 			auto curr = q.poll();
-			if (curr.id == t) { break; } // ·
-			for (auto& e : adj[curr.id]) {
-				if (dist[curr.id] + e.w < dist[e.tid]) {
-					predecessor[e.tid] = curr.id;
-					dist[e.tid] = dist[curr.id] + e.w;
-					if (visited[e.tid]) {
-						q.update({ e.tid, dist[e.tid] }); // ڶdistֵ
+			ws.count_settled();
+			for (int i = g.begin(curr.id); i < g.end(curr.id); ++i) {
+				int v = static_cast<int>(g.targets[i]);
+				D nd = sat_add(curr.dist, g.weights[i]);
+				if (nd < ws.get_dist(v)) {
+					ws.set_dist(v, nd, curr.id);
+					if (q.contains(v)) {
+						q.decrease_key(v, nd);
 					}
 					else {
-						q.add({ e.tid, dist[e.tid] });
-						visited[e.tid] = true;
+						q.add({ v, nd });
 					}
 				}
+				D od = other.get_dist(v);
+				if (od < inf && sat_add(ws.get_dist(v), od) < mu) { // 两侧在v相遇
+					mu = sat_add(ws.get_dist(v), od);
+					bws.meet = v;
+				}
 			}
 		}
+		return mu;
+	}
+
+	void dijkstraBidirectional(int s, int t) const {
+		BidirectionalWorkspace ws(v_num);
+		D d = bidirectional_query(s, t, ws);
+		if (ws.meet == -1) {
+			cout << s << "->" << t << ": 不可达" << endl;
+			return;
+		}
+		vector<int> p = ws.path(s, t);
+		for (size_t i = 0; i < p.size(); ++i) { cout << (i ? "->" : "") << p[i]; }
+		cout << endl << s << "->" << t << ": " << d << endl;
+		cout << "双向搜索出队顶点数: " << ws.settled_num() << endl;
+	}
+
+	// 基数堆不支持删除，同一顶点可能多次入队，出队时跳过过期的dist
+	void dijkstraWithRadixHeap(int s, int t) const {
+		vector<D> dist;
+		vector<int> predecessor;
+		DijkstraStats stats;
+		dijkstra<RadixHeapPolicy>(s, t, dist, predecessor, stats);
+		print_path(s, t, predecessor);
+		print_dist(s, t, dist);
+		cout << "基数堆中剩余元素: " << stats.remaining << endl;
+		cout << stats << endl;
+	}
+
+	// D叉堆版本，与dijkstraWithCusQueue相同，仅替换队列类型
+	template<int Arity>
+	void dijkstraWithDaryHeap(int s, int t) const {
+		vector<D> dist;
+		vector<int> predecessor;
+		DijkstraStats stats;
+		dijkstra<DaryHeapPolicy<Arity>>(s, t, dist, predecessor, stats);
 		print_path(s, t, predecessor);
 		print_dist(s, t, dist);
-		cout << "ԶȶʣԪ: " << q.size() << endl;
+		cout << Arity << "叉堆中剩余元素: " << stats.remaining << endl;
+		cout << stats << endl;
 	}
 
-	void print_path(int s, int t, vector<int>& predecessor) {
+	void print_path(int s, int t, const vector<int>& predecessor) const {
 		if (s == t) {
 			cout << s;
 			return;
 		}
+		if (predecessor[t] == -1) { // 未到达t
+			cout << s << "->" << t << ": unreachable";
+			return;
+		}
 		print_path(s, predecessor[t], predecessor);
 		cout << "->" << t;
 	}
 
-	void print_dist(int s, int t, vector<int>& dist) {
+	void print_dist(int s, int t, const vector<D>& dist) const {
 		cout << endl << s << "->" << t << ": " << dist[t] << endl;
 	}
 
+private:
+	struct SnapshotHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t v_num;
+		uint32_t e_num;
+		uint8_t id_bytes;           // sizeof(Id)
+		uint8_t weight_bytes;       // sizeof(W)
+		uint8_t reserved[6];
+		uint64_t section_offset[6]; // 各段相对文件头的字节偏移
+		uint64_t section_checksum[6];
+		uint64_t header_checksum;   // 以上全部字段的校验和
+	};
+
+	static const char* snapshot_magic() { return "GCSR"; }
+
+	static constexpr uint32_t snapshot_version = 2; // 2: 头部增加编号与权重宽度
+	static constexpr size_t snapshot_align = 64;
+
+	static uint64_t align_up(uint64_t pos) { return (pos + snapshot_align - 1) / snapshot_align * snapshot_align; }
+
+	// h为前一段的结果时可以分段连续计算
+	static uint64_t fnv1a(const void* data, size_t bytes, uint64_t h = 14695981039346656037ull) {
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < bytes; ++i) {
+			h ^= p[i];
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// 第i段(0: offsets, 1: targets, 2: weights)的数据与字节数
+	static const void* section_data(const AdjType& g, int i) {
+		if (i == 0) return g.offsets;
+		return i == 1 ? static_cast<const void*>(g.targets) : static_cast<const void*>(g.weights);
+	}
+
+	// 按64位计算，n为INT32_MAX或size_t为32位时也不会溢出
+	static uint64_t section_bytes(int i, int n, int m) {
+		return i == 0 ? (static_cast<uint64_t>(n) + 1) * sizeof(int32_t) : static_cast<uint64_t>(m) * (i == 1 ? sizeof(Id) : sizeof(W));
+	}
+
+	// 已在内存中的图，大小一定能用size_t表示
+	size_t section_bytes(int i) const { return static_cast<size_t>(section_bytes(i, v_num, adj.edge_num())); }
+
+	// offsets从0单调不减到m，终点编号都在[0, n)内，边权非负
+	static bool valid_csr(int n, int m, const int* offsets, const Id* targets, const W* weights) {
+		if (offsets[0] != 0 || offsets[n] != m) return false;
+		for (int u = 0; u < n; ++u) {
+			if (offsets[u] > offsets[u + 1]) return false;
+		}
+		for (int i = 0; i < m; ++i) {
+			int64_t t = static_cast<int64_t>(targets[i]);
+			if (t < 0 || t >= n || weights[i] < static_cast<W>(0)) return false;
+		}
+		return true;
+	}
+
 private:
 	int v_num;
-	vector<int> dist; // ·
-	AdjList adj;
+	vector<EdgeType> edges; // freeze()前的边缓存
+	AdjType adj;
+	AdjType radj; // 反向图，双向搜索的后向部分使用
+	std::shared_ptr<const MappedFile> mapping; // load_snapshot()打开的文件，adj/radj可能直接指向其中
 };
 
+using Graph = BasicGraph<int, int, int>;
+
 
 #endif // MYCPPPITFALLS_SHORTESTPATH_HPP
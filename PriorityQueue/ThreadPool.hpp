@@ -0,0 +1,110 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_THREADPOOL_HPP
+#define MYCPPPITFALLS_THREADPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+
+/*
+fork-join线程池：线程常驻，run(fn)让所有线程各执行一次fn(tid)并等待全部完成.
+调用线程本身作为0号线程参与计算，因此ThreadPool(1)不创建任何线程.
+*/
+class ThreadPool {
+public:
+	explicit ThreadPool(int n = static_cast<int>(std::thread::hardware_concurrency()))
+		: thread_num(std::max(n, 1)), epoch(0), done(0), stop(false), task(nullptr) {
+		for (int tid = 1; tid < thread_num; ++tid) {
+			workers.emplace_back([this, tid] { work(tid); });
+		}
+	}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			stop = true;
+		}
+		start_cv.notify_all();
+		for (auto& th : workers) { th.join(); }
+	}
+
+	int size() const { return thread_num; }
+
+	// 所有线程执行fn(tid)，tid ∈ [0, size())
+	void run(const std::function<void(int)>& fn) {
+		if (thread_num == 1) {
+			fn(0);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			task = &fn;
+			done = 0;
+			++epoch;
+		}
+		start_cv.notify_all();
+		fn(0);
+		std::unique_lock<std::mutex> lock(mtx);
+		done_cv.wait(lock, [this] { return done == thread_num - 1; });
+		task = nullptr;
+	}
+
+	// 动态分配区间[0, n)，每次领取grain个下标，fn(i, tid)
+	void parallel_for(size_t n, const std::function<void(size_t, int)>& fn, size_t grain = 1) {
+		std::atomic<size_t> next(0);
+		run([&](int tid) {
+			while (true) {
+				size_t begin = next.fetch_add(grain);
+				if (begin >= n) break;
+				size_t end = std::min(begin + grain, n);
+				for (size_t i = begin; i < end; ++i) { fn(i, tid); }
+			}
+		});
+	}
+
+private:
+	void work(int tid) {
+		size_t seen = 0;
+		while (true) {
+			const std::function<void(int)>* fn;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				start_cv.wait(lock, [&] { return stop || epoch != seen; });
+				if (stop) return;
+				seen = epoch;
+				fn = task;
+			}
+			(*fn)(tid);
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				++done;
+			}
+			done_cv.notify_one();
+		}
+	}
+
+private:
+	int thread_num;
+	std::vector<std::thread> workers;
+	std::mutex mtx;
+	std::condition_variable start_cv;
+	std::condition_variable done_cv;
+	size_t epoch; // 每次run()加一，唤醒等待中的线程
+	int done;
+	bool stop;
+	const std::function<void(int)>* task;
+};
+
+#endif // MYCPPPITFALLS_THREADPOOL_HPP
@@ -0,0 +1,191 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_VERTEXORDER_HPP
+#define MYCPPPITFALLS_VERTEXORDER_HPP
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "ShortestPath.hpp"
+
+
+/*
+顶点重排：给顶点重新编号，使相邻顶点的编号(也就是dist、offsets等数组中的位置)尽量接近，
+松弛时访问的内存集中在少数缓存行内.
+排列统一表示为 perm[原编号] = 新编号.
+   bfs_order：按无向BFS的访问顺序编号.
+   cuthill_mckee_order：BFS中邻居按度数从小到大入队，起点取度数最小的顶点，反转后(RCM)带宽更小.
+   partition_order：按划分结果(如METIS输出)分块，块内保持RCM顺序，同一子图的顶点连续存放.
+*/
+namespace order {
+	// 无向邻居(出边与入边)
+	template<typename Fn>
+	void for_each_neighbor(const Graph& g, int u, Fn fn) {
+		const CsrAdj& adj = g.adjacency();
+		const CsrAdj& radj = g.reverse_adjacency();
+		for (int i = adj.begin(u); i < adj.end(u); ++i) { fn(adj.targets[i]); }
+		for (int i = radj.begin(u); i < radj.end(u); ++i) { fn(radj.targets[i]); }
+	}
+
+	inline int degree(const Graph& g, int u) {
+		const CsrAdj& adj = g.adjacency();
+		const CsrAdj& radj = g.reverse_adjacency();
+		return adj.end(u) - adj.begin(u) + radj.end(u) - radj.begin(u);
+	}
+
+	// 按访问顺序返回顶点序列；by_degree为true时邻居按度数升序入队，每个连通分量从度数最小的顶点开始
+	inline vector<int> bfs_sequence(const Graph& g, bool by_degree) {
+		int n = g.vertex_num();
+		vector<int> seq;
+		seq.reserve(n);
+		vector<char> visited(n, 0);
+		vector<int> starts(n), deg(n);
+		for (int v = 0; v < n; ++v) {
+			starts[v] = v;
+			deg[v] = degree(g, v);
+		}
+		if (by_degree) {
+			std::stable_sort(starts.begin(), starts.end(), [&](int a, int b) { return deg[a] < deg[b]; });
+		}
+		vector<int> next;
+		for (int s : starts) {
+			if (visited[s]) continue;
+			visited[s] = 1;
+			size_t head = seq.size();
+			seq.push_back(s);
+			while (head < seq.size()) {
+				int u = seq[head++];
+				next.clear();
+				for_each_neighbor(g, u, [&](int v) {
+					if (!visited[v]) {
+						visited[v] = 1;
+						next.push_back(v);
+					}
+				});
+				if (by_degree) {
+					std::stable_sort(next.begin(), next.end(), [&](int a, int b) { return deg[a] < deg[b]; });
+				}
+				seq.insert(seq.end(), next.begin(), next.end());
+			}
+		}
+		return seq;
+	}
+
+	inline vector<int> to_permutation(const vector<int>& seq) {
+		vector<int> perm(seq.size());
+		for (size_t i = 0; i < seq.size(); ++i) { perm[seq[i]] = static_cast<int>(i); }
+		return perm;
+	}
+}
+
+inline vector<int> bfs_order(const Graph& g) {
+	return order::to_permutation(order::bfs_sequence(g, false));
+}
+
+inline vector<int> cuthill_mckee_order(const Graph& g, bool reverse = true) {
+	vector<int> seq = order::bfs_sequence(g, true);
+	if (reverse) std::reverse(seq.begin(), seq.end());
+	return order::to_permutation(seq);
+}
+
+// part[v]为顶点v所属子图，大小须等于顶点数
+inline vector<int> partition_order(const Graph& g, const vector<int>& part) {
+	vector<int> seq = order::bfs_sequence(g, true);
+	std::reverse(seq.begin(), seq.end());
+	std::stable_sort(seq.begin(), seq.end(), [&](int a, int b) { return part[a] < part[b]; });
+	return order::to_permutation(seq);
+}
+
+// 读取LearnMetis输出的划分文件，每行 "顶点编号(从1开始) 子图编号"；失败时返回空
+inline vector<int> read_partition(const std::string& path, int v_num) {
+	std::ifstream in(path);
+	if (!in) return {};
+	vector<int> part(v_num, -1);
+	std::string line;
+	while (getline(in, line)) {
+		std::istringstream tmp(line);
+		int v, p;
+		if (!(tmp >> v >> p)) continue;
+		if (v < 1 || v > v_num) return {};
+		part[v - 1] = p;
+	}
+	for (int p : part) {
+		if (p < 0) return {};
+	}
+	return part;
+}
+
+// 按perm重新编号得到的新图，每个顶点的出边保持原来的相对顺序
+inline Graph permute_graph(const Graph& g, const vector<int>& perm) {
+	const CsrAdj& adj = g.adjacency();
+	Graph res(g.vertex_num());
+	vector<int> inv(perm.size());
+	for (size_t v = 0; v < perm.size(); ++v) { inv[perm[v]] = static_cast<int>(v); }
+	for (int nu = 0; nu < g.vertex_num(); ++nu) {
+		int u = inv[nu];
+		for (int i = adj.begin(u); i < adj.end(u); ++i) { res.add_edge(nu, perm[adj.targets[i]], adj.weights[i]); }
+	}
+	res.freeze();
+	return res;
+}
+
+
+/*
+重排后的图：内部以新编号存储并查询，对外的输入输出一律使用原编号，调用者无需感知重排.
+*/
+class ReorderedGraph {
+public:
+	ReorderedGraph(const Graph& original, const vector<int>& new_id) : perm(new_id), inv(new_id.size()), g(permute_graph(original, new_id)) {
+		for (size_t v = 0; v < perm.size(); ++v) { inv[perm[v]] = static_cast<int>(v); }
+	}
+
+	const Graph& graph() const { return g; }
+
+	int to_inner(int v) const { return perm[v]; }
+
+	int to_outer(int v) const { return inv[v]; }
+
+	// 与Graph::query相同，ws为重排后图的工作区，路径通过path(s, t, ws)获取
+	int query(int s, int t, QueryWorkspace& ws) const {
+		return g.query(perm[s], t < 0 ? -1 : perm[t], ws);
+	}
+
+	vector<int> path(int s, int t, const QueryWorkspace& ws) const {
+		if (t < 0) return {};
+		vector<int> p = ws.path(perm[s], perm[t]);
+		for (int& v : p) { v = inv[v]; }
+		return p;
+	}
+
+	DistanceTable distance_table(const vector<int>& sources, const vector<int>& targets, ThreadPool& pool) const {
+		vector<int> s(sources.size()), t(targets.size());
+		for (size_t i = 0; i < sources.size(); ++i) { s[i] = perm[sources[i]]; }
+		for (size_t j = 0; j < targets.size(); ++j) { t[j] = perm[targets[j]]; }
+		return g.distance_table(s, t, pool); // 行列顺序与输入一致，无需变换
+	}
+
+	// dist、predecessor按原编号给出
+	template<typename QueuePolicy, typename Stats = NoStats>
+	int dijkstra(int s, int t, vector<int>& dist, vector<int>& predecessor, Stats&& stats = Stats()) const {
+		vector<int> d, pre;
+		int res = g.dijkstra<QueuePolicy>(perm[s], t < 0 ? -1 : perm[t], d, pre, std::forward<Stats>(stats));
+		int n = g.vertex_num();
+		dist.resize(n);
+		predecessor.resize(n);
+		for (int v = 0; v < n; ++v) {
+			dist[v] = d[perm[v]];
+			predecessor[v] = pre[perm[v]] < 0 ? -1 : inv[pre[perm[v]]];
+		}
+		return res;
+	}
+
+private:
+	vector<int> perm; // 原编号 -> 新编号
+	vector<int> inv;  // 新编号 -> 原编号
+	Graph g;
+};
+
+#endif // MYCPPPITFALLS_VERTEXORDER_HPP
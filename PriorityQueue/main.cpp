@@ -1,9 +1,14 @@
 ﻿// PriorityQueue.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
 //
 
-#include "ShortestPath.hpp"
+#include "ALT.hpp"
+#include "DynamicSSSP.hpp"
+#include "MultiQueue.hpp"
+#include "PathCache.hpp"
+#include "VertexOrder.hpp"
 
-int main() {
+// 用法: PriorityQueue [ALT预处理文件]，给出文件时优先加载，文件不存在或与图不一致时重新预处理并保存
+int main(int argc, char* argv[]) {
 
 	Graph myGraph(6);
 	myGraph.add_edge(0, 1, 10);
@@ -14,10 +19,69 @@ int main() {
 	myGraph.add_edge(3, 2, 1);
 	myGraph.add_edge(3, 5, 12);
 	myGraph.add_edge(4, 5, 10);
+	myGraph.freeze();
 
 	myGraph.dijkstraWithSTLQueue(0, 5);
 	myGraph.dijkstraWithSTLSet(0, 5);
+	myGraph.dijkstraWithHandleSet(0, 5);
 	myGraph.dijkstraWithCusQueue(0, 5);
+	myGraph.dijkstraWithDaryHeap<4>(0, 5);
+	myGraph.dijkstraWithDaryHeap<8>(0, 5);
+	myGraph.dijkstraWithRadixHeap(0, 5);
+	myGraph.dijkstraBidirectional(0, 5);
+
+	ThreadPool pool(4);
+	vector<std::pair<int, int>> queries = { { 0, 5 }, { 0, 2 }, { 1, 5 }, { 3, 5 } };
+	vector<int> res = myGraph.batch_query(queries, pool);
+	for (size_t i = 0; i < queries.size(); ++i) {
+		cout << queries[i].first << "->" << queries[i].second << ": " << res[i] << endl;
+	}
+	DistanceTable table = myGraph.distance_table({ 0, 1, 3 }, { 2, 5 }, pool);
+	for (int i = 0; i < table.rows; ++i) {
+		for (int j = 0; j < table.cols; ++j) { cout << table.at(i, j) << " "; }
+		cout << endl;
+	}
+	MultiQueueSSSP parallel_sssp(myGraph);
+	parallel_sssp.run(0, pool); // 4个线程共享一个MultiQueue
+	cout << "MultiQueue 0->5: " << parallel_sssp.distances()[5] << ", 处理次数: " << parallel_sssp.processed_num() << endl;
+
+	PathCache cache(myGraph, 1 << 20); // 最多缓存1MB的最短路树
+	for (int t : { 5, 2, 4 }) {
+		vector<int> p = cache.path(0, t);
+		cout << "缓存 0->" << t << ": " << cache.query(0, t) << ", 路径顶点数: " << p.size() << endl;
+	}
+	cout << "缓存命中: " << cache.stats().hits << ", 未命中: " << cache.stats().misses << endl;
+
+	ALT alt;
+	std::string alt_path = argc > 1 ? argv[1] : "";
+	if (alt_path.empty() || !alt.load(alt_path, myGraph)) {
+		alt.preprocess(myGraph, 2);
+		if (!alt_path.empty()) alt.save(alt_path);
+	}
+	QueryWorkspace ws(myGraph.vertex_num());
+	cout << "ALT 0->5: " << alt.query(myGraph, 0, 5, ws) << ", 出队顶点数: " << ws.settled_num() << endl;
+
+	Graph mapped(0);
+	if (myGraph.save_snapshot("graph.bin") && mapped.load_snapshot("graph.bin", true)) { // 映射打开，不复制
+		cout << "快照 0->5: " << mapped.query(0, 5, ws) << endl;
+	}
+
+	ReorderedGraph reordered(myGraph, cuthill_mckee_order(myGraph)); // 内部重新编号，对外仍使用原编号
+	cout << "RCM重排后 0->5: " << reordered.query(0, 5, ws) << endl;
+
+	DynamicSSSP sssp(myGraph, 0);
+	myGraph.update_edge(3, 2, 20); // 树边变长
+	myGraph.remove_edge(4, 5);
+	sssp.repair(myGraph, { { 3, 2 }, { 4, 5 } });
+	cout << "修改后 0->5: " << sssp.distances()[5] << ", 重新确定的顶点数: " << sssp.touched_num() << endl;
+
+	BasicGraph<uint32_t, uint32_t, uint64_t> wide(4); // 路径长度超过int范围时使用64位距离
+	wide.add_edge(0, 1, 2000000000u);
+	wide.add_edge(1, 2, 2000000000u);
+	wide.add_edge(2, 3, 2000000000u);
+	wide.freeze();
+	decltype(wide)::Workspace wide_ws(wide.vertex_num());
+	cout << "64位距离 0->3: " << wide.query(0, 3, wide_ws) << endl;
 
 	return 0;
 }
@@ -0,0 +1,109 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+#ifndef MYCPPPITFALLS_GRAPHGENERATOR_HPP
+#define MYCPPPITFALLS_GRAPHGENERATOR_HPP
+
+#include <random>
+#include <string>
+#include <cstdint>
+#include "ShortestPath.hpp"
+
+
+/*
+可复现的合成图生成器，相同参数与种子总是得到相同的图：
+   random: G(n,m)，m条起终点均匀随机的有向边；
+   grid:   side*side网格，相邻格点双向连边，模拟路网(度数低、直径大)；
+   rmat:   R-MAT递归矩阵(a,b,c,d)=(0.57,0.19,0.19,0.05)，度数呈幂律分布.
+边权均匀分布在[1, max_w].
+*/
+struct GraphSpec {
+	std::string family; // random / grid / rmat
+	int n;
+	int m;              // grid忽略该参数，由网格大小决定
+	int max_w;
+	uint32_t seed;
+};
+
+inline int random_weight(std::mt19937& rng, int max_w) {
+	return static_cast<int>(rng() % static_cast<uint32_t>(max_w)) + 1;
+}
+
+// [0, 1)上的均匀实数，由两次rng()拼成53位；std::uniform_real_distribution的算法由实现决定，各编译器结果不同
+inline double random_unit(std::mt19937& rng) {
+	uint64_t hi = rng() >> 5, lo = rng() >> 6; // 27位 + 26位
+	return static_cast<double>(hi << 26 | lo) * (1.0 / 9007199254740992.0);
+}
+
+inline void generate_random(Graph& g, int n, int m, int max_w, std::mt19937& rng) {
+	for (int i = 0; i < m; ++i) {
+		int s = static_cast<int>(rng() % n), t = static_cast<int>(rng() % n);
+		g.add_edge(s, t, random_weight(rng, max_w));
+	}
+}
+
+inline void generate_grid(Graph& g, int side, int max_w, std::mt19937& rng) {
+	for (int r = 0; r < side; ++r) {
+		for (int c = 0; c < side; ++c) {
+			int u = r * side + c;
+			if (c + 1 < side) {
+				int w = random_weight(rng, max_w);
+				g.add_edge(u, u + 1, w);
+				g.add_edge(u + 1, u, w);
+			}
+			if (r + 1 < side) {
+				int w = random_weight(rng, max_w);
+				g.add_edge(u, u + side, w);
+				g.add_edge(u + side, u, w);
+			}
+		}
+	}
+}
+
+// 每条边在2^scale的邻接矩阵中逐层选择四个象限之一，顶点数不是2的幂时取模
+inline void generate_rmat(Graph& g, int n, int m, int max_w, std::mt19937& rng) {
+	int scale = 0;
+	while ((1LL << scale) < n) ++scale;
+	const double a = 0.57, b = 0.19, c = 0.19;
+	for (int i = 0; i < m; ++i) {
+		long long s = 0, t = 0;
+		for (int level = 0; level < scale; ++level) {
+			double r = random_unit(rng);
+			s <<= 1;
+			t <<= 1;
+			if (r < a) {}
+			else if (r < a + b) { t |= 1; }
+			else if (r < a + b + c) { s |= 1; }
+			else { s |= 1; t |= 1; }
+		}
+		g.add_edge(static_cast<int>(s % n), static_cast<int>(t % n), random_weight(rng, max_w));
+	}
+}
+
+// 按spec生成并freeze，grid的顶点数向下取整为完全平方数
+inline Graph generate_graph(GraphSpec& spec) {
+	std::mt19937 rng(spec.seed);
+	if (spec.family == "grid") {
+		int side = 1;
+		while (static_cast<long long>(side + 1) * (side + 1) <= spec.n) ++side;
+		spec.n = side * side;
+		Graph g(spec.n);
+		generate_grid(g, side, spec.max_w, rng);
+		g.freeze();
+		spec.m = g.edge_num();
+		return g;
+	}
+	Graph g(spec.n);
+	if (spec.family == "rmat") {
+		generate_rmat(g, spec.n, spec.m, spec.max_w, rng);
+	}
+	else {
+		generate_random(g, spec.n, spec.m, spec.max_w, rng);
+	}
+	g.freeze();
+	return g;
+}
+
+#endif // MYCPPPITFALLS_GRAPHGENERATOR_HPP
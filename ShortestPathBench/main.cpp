@@ -0,0 +1,553 @@
+﻿// ShortestPathBench.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <string>
+#include "GraphGenerator.hpp"
+#include "DeltaStepping.hpp"
+#include "ALT.hpp"
+#include "ContractionHierarchies.hpp"
+#include "VertexOrder.hpp"
+#include "CompressedAdj.hpp"
+#include "MultiQueue.hpp"
+#include "PathCache.hpp"
+#include "Partitioner.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/*
+堆内存计数：替换全局operator new/delete，记录当前与峰值字节数.
+   进程的峰值常驻内存单调不减，无法区分各项测试；每项测试开始时reset()把峰值置为当前值，
+   结束时peak_kb()为测试期间相对起点的峰值，即队列、工作区等占用的内存，不含已建好的输入图.
+*/
+namespace heap_counter {
+	std::atomic<size_t> current(0), peak(0), base(0);
+	const size_t header = alignof(std::max_align_t); // 块前保存大小，保持对齐
+
+	void* allocate(size_t size) noexcept {
+		char* p = static_cast<char*>(std::malloc(size + header));
+		if (!p) return nullptr;
+		*reinterpret_cast<size_t*>(p) = size;
+		size_t now = current.fetch_add(size, std::memory_order_relaxed) + size;
+		size_t old = peak.load(std::memory_order_relaxed);
+		while (now > old && !peak.compare_exchange_weak(old, now, std::memory_order_relaxed)) {}
+		return p + header;
+	}
+
+	void release(void* ptr) noexcept {
+		if (!ptr) return;
+		char* p = static_cast<char*>(ptr) - header;
+		current.fetch_sub(*reinterpret_cast<size_t*>(p), std::memory_order_relaxed);
+		std::free(p);
+	}
+
+	void reset() {
+		base = current.load();
+		peak = base.load();
+	}
+
+	size_t peak_kb() { return (peak - base) / 1024; }
+}
+
+void* operator new(size_t size) {
+	void* p = heap_counter::allocate(size);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return heap_counter::allocate(size); }
+void operator delete(void* p) noexcept { heap_counter::release(p); }
+void operator delete(void* p, size_t) noexcept { heap_counter::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { heap_counter::release(p); }
+
+struct Result {
+	std::string family;
+	int n;
+	int m;
+	std::string algorithm;
+	int threads;
+	int queries;
+	double ms_per_query;
+	double settled_per_query; // 平均出队(确定最短路)的顶点数
+	size_t queue_peak;        // 队列峰值元素数
+	size_t peak_heap_kb;      // 测试期间堆内存峰值(KB)，见heap_counter
+	int mismatch;             // 与参考Dijkstra距离不一致的查询数
+	double cache_misses_per_query; // 模拟缓存的平均缺失次数，只有顶点重排测试填写
+	double bytes_per_edge;         // 邻接表每条边占用的字节数，只有邻接表存储测试填写
+};
+
+/*
+直接映射缓存模拟：256KB，64字节缓存行，按地址记录Dijkstra访问offsets/targets/weights/dist的缺失次数，
+不依赖硬件计数器，结果可复现，用于比较不同顶点编号的局部性.
+*/
+class CacheSim {
+public:
+	CacheSim() : tags(4096) {}
+
+	void reset() {
+		std::fill(tags.begin(), tags.end(), ~uintptr_t(0));
+		misses = 0;
+	}
+
+	void touch(const void* p) {
+		uintptr_t line = reinterpret_cast<uintptr_t>(p) / 64;
+		uintptr_t& tag = tags[line % tags.size()];
+		if (tag != line) {
+			tag = line;
+			++misses;
+		}
+	}
+
+	size_t miss_num() const { return misses; }
+
+private:
+	vector<uintptr_t> tags;
+	size_t misses = 0;
+};
+
+// 与Graph::query相同的搜索过程，同时把内存访问送入缓存模拟
+void traced_query(const Graph& g, int s, int t, vector<int>& dist, CacheSim& cache) {
+	const CsrAdj& adj = g.adjacency();
+	dist.assign(g.vertex_num(), INF);
+	cache.reset();
+	dist[s] = 0;
+	PriorityQueue3 q(g.vertex_num());
+	q.add({ s, 0 });
+	while (!q.empty()) {
+		auto curr = q.poll();
+		if (curr.id == t) break;
+		cache.touch(adj.offsets + curr.id);
+		for (int i = adj.begin(curr.id); i < adj.end(curr.id); ++i) {
+			int v = adj.targets[i], w = adj.weights[i];
+			cache.touch(adj.targets + i);
+			cache.touch(adj.weights + i);
+			cache.touch(&dist[v]);
+			if (curr.dist + w < dist[v]) {
+				dist[v] = curr.dist + w;
+				if (q.contains(v)) {
+					q.decrease_key(v, dist[v]);
+				}
+				else {
+					q.add({ v, dist[v] });
+				}
+			}
+		}
+	}
+}
+
+class Bench {
+public:
+	Bench(const GraphSpec& spec, const Graph& g, int query_num) : spec(spec), g(g) {
+		std::mt19937 rng(spec.seed + 1);
+		for (int i = 0; i < query_num; ++i) {
+			queries.emplace_back(static_cast<int>(rng() % spec.n), static_cast<int>(rng() % spec.n));
+		}
+		QueryWorkspace ws(spec.n);
+		for (auto& q : queries) { reference.push_back(g.query(q.first, q.second, ws)); }
+	}
+
+	template<typename QueuePolicy>
+	Result run_policy(const std::string& name) const {
+		heap_counter::reset();
+		vector<int> dist, predecessor;
+		size_t settled = 0, peak = 0;
+		int mismatch = 0;
+		auto start = Clock::now();
+		for (size_t i = 0; i < queries.size(); ++i) {
+			DijkstraStats stats;
+			int d = g.dijkstra<QueuePolicy>(queries[i].first, queries[i].second, dist, predecessor, stats);
+			settled += stats.pops - stats.stale_pops;
+			peak = std::max(peak, stats.peak_size);
+			if (d != reference[i]) ++mismatch;
+		}
+		return make(name, 1, elapsed_ms(start), settled, peak, mismatch);
+	}
+
+	// 基于工作区的查询：Graph::query、ALT::query；Workspace为其他宽度的图使用的工作区
+	template<typename Workspace = QueryWorkspace, typename Query>
+	Result run_workspace(const std::string& name, Query query) const {
+		heap_counter::reset();
+		Workspace ws(spec.n);
+		size_t settled = 0;
+		int mismatch = 0;
+		auto start = Clock::now();
+		for (size_t i = 0; i < queries.size(); ++i) {
+			if (query(queries[i].first, queries[i].second, ws) != reference[i]) ++mismatch;
+			settled += ws.settled_num();
+		}
+		return make(name, 1, elapsed_ms(start), settled, 0, mismatch);
+	}
+
+	// 最短路树缓存：全部查询重复passes遍，trees为缓存容量可容纳的树数，小于起点数时LRU会反复淘汰
+	Result run_cache(const std::string& name, int trees, int passes) const {
+		heap_counter::reset();
+		size_t tree_bytes = sizeof(ShortestPathTree) + 2 * static_cast<size_t>(spec.n) * sizeof(int);
+		PathCache cache(g, trees * tree_bytes);
+		int mismatch = 0;
+		auto start = Clock::now();
+		for (int k = 0; k < passes; ++k) {
+			for (size_t i = 0; i < queries.size(); ++i) {
+				if (cache.query(queries[i].first, queries[i].second) != reference[i]) ++mismatch;
+			}
+		}
+		double ms = elapsed_ms(start);
+		return make(name, 1, ms, 0, 0, mismatch, static_cast<int>(queries.size()) * passes);
+	}
+
+	// 顶点重排：shuffled为打乱编号的图(模拟真实输入顺序)，shuffle[v]为g中顶点v在其中的编号，perm为待测重排
+	Result run_order(const std::string& name, const Graph& shuffled, const vector<int>& shuffle, const vector<int>& perm) const {
+		heap_counter::reset();
+		ReorderedGraph rg(shuffled, perm);
+		QueryWorkspace ws(spec.n);
+		size_t settled = 0;
+		int mismatch = 0;
+		auto start = Clock::now();
+		for (size_t i = 0; i < queries.size(); ++i) {
+			if (rg.query(shuffle[queries[i].first], shuffle[queries[i].second], ws) != reference[i]) ++mismatch;
+			settled += ws.settled_num();
+		}
+		Result r = make(name, 1, elapsed_ms(start), settled, 0, mismatch);
+		CacheSim cache;
+		vector<int> dist;
+		size_t misses = 0;
+		for (auto& q : queries) {
+			traced_query(rg.graph(), rg.to_inner(shuffle[q.first]), rg.to_inner(shuffle[q.second]), dist, cache);
+			misses += cache.miss_num();
+		}
+		r.cache_misses_per_query = static_cast<double>(misses) / queries.size();
+		return r;
+	}
+
+	/*
+	CH查询计时后再逐个校验(不计时)：距离与dijkstraWithCusQueue使用的IndexedHeapPolicy一致，
+	展开捷径后的路径从s到t、相邻顶点之间有原图的边、边权之和等于返回的距离；任一不满足计为mismatch.
+	*/
+	Result run_ch(const ContractionHierarchies& ch) const {
+		heap_counter::reset();
+		ContractionHierarchies::Workspace cw(spec.n);
+		size_t settled = 0;
+		auto start = Clock::now();
+		for (size_t i = 0; i < queries.size(); ++i) {
+			ch.query(queries[i].first, queries[i].second, cw);
+			settled += cw.fw.settled_num() + cw.bw.settled_num();
+		}
+		double ms = elapsed_ms(start);
+		int mismatch = 0;
+		vector<int> dist, predecessor;
+		for (auto& q : queries) {
+			int d = ch.query(q.first, q.second, cw);
+			if (d != g.dijkstra<IndexedHeapPolicy>(q.first, q.second, dist, predecessor) || !valid_path(ch.path(q.first, q.second, cw), q.first, q.second, d)) ++mismatch;
+		}
+		return make("ch", 1, ms, settled, 0, mismatch);
+	}
+
+	// 单源全部最短路：Dijkstra与delta-stepping、MultiQueue标号修正在1..N线程下的对比
+	vector<Result> run_sssp(int delta, int sources) const {
+		vector<Result> res;
+		vector<vector<int>> ref(sources);
+		heap_counter::reset();
+		QueryWorkspace ws(spec.n);
+		size_t reached = 0;
+		auto start = Clock::now();
+		for (int i = 0; i < sources; ++i) {
+			g.query(queries[i].first, -1, ws);
+			for (int v = 0; v < spec.n; ++v) {
+				ref[i].push_back(ws.get_dist(v));
+				if (ws.get_dist(v) < INF) ++reached;
+			}
+		}
+		res.push_back(make("dijkstra-sssp", 1, elapsed_ms(start), reached, 0, 0, sources));
+		int max_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+		for (int threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+			ThreadPool pool(threads);
+			int mismatch = 0;
+			heap_counter::reset();
+			DeltaStepping ds(g, delta);
+			start = Clock::now();
+			for (int i = 0; i < sources; ++i) {
+				ds.run(queries[i].first, pool);
+				if (ds.distances() != ref[i]) ++mismatch;
+			}
+			res.push_back(make("delta-stepping", threads, elapsed_ms(start), reached, 0, mismatch, sources));
+			mismatch = 0;
+			size_t processed = 0;
+			heap_counter::reset();
+			MultiQueueSSSP mq(g);
+			start = Clock::now();
+			for (int i = 0; i < sources; ++i) {
+				mq.run(queries[i].first, pool);
+				processed += mq.processed_num();
+				if (mq.distances() != ref[i]) ++mismatch;
+			}
+			res.push_back(make("multiqueue-sssp", threads, elapsed_ms(start), processed, 0, mismatch, sources));
+			if (threads == max_threads) break;
+		}
+		return res;
+	}
+
+	Result make(const std::string& name, int threads, double ms, size_t settled, size_t peak, int mismatch, int count = -1) const {
+		int qn = count < 0 ? static_cast<int>(queries.size()) : count;
+		return { spec.family, spec.n, spec.m, name, threads, qn, ms / qn, static_cast<double>(settled) / qn, peak, heap_counter::peak_kb(), mismatch, 0, 0 };
+	}
+
+private:
+	// 路径p是否为原图中s到t、长度为d的路径；不可达时应为空
+	bool valid_path(const vector<int>& p, int s, int t, int d) const {
+		if (d == INF) return p.empty();
+		if (p.empty() || p.front() != s || p.back() != t) return false;
+		long long len = 0;
+		for (size_t i = 0; i + 1 < p.size(); ++i) {
+			int w = g.edge_weight(p[i], p[i + 1]);
+			if (w == INF) return false;
+			len += w;
+		}
+		return len == d;
+	}
+
+private:
+	const GraphSpec& spec;
+	const Graph& g;
+	vector<std::pair<int, int>> queries;
+	vector<int> reference;
+};
+
+// 把g复制为其他存储宽度的图G后测查询，不可达统一换成INF再与int版本的结果比较
+template<typename G>
+Result run_width(const Bench& bench, const Graph& g, const std::string& name) {
+	using D = typename G::VertexType::dist_type;
+	const CsrAdj& adj = g.adjacency();
+	G wide(g.vertex_num());
+	for (int u = 0; u < g.vertex_num(); ++u) {
+		for (int i = adj.begin(u); i < adj.end(u); ++i) {
+			wide.add_edge(u, adj.targets[i], static_cast<typename G::AdjType::weight_type>(adj.weights[i]));
+		}
+	}
+	wide.freeze();
+	Result r = bench.run_workspace<typename G::Workspace>(name, [&](int s, int t, typename G::Workspace& ws) {
+		D d = wide.query(s, t, ws);
+		return d == DistTraits<D>::inf() ? INF : static_cast<int>(d);
+	});
+	size_t id_bytes = sizeof(typename G::AdjType::id_type), w_bytes = sizeof(typename G::AdjType::weight_type);
+	r.bytes_per_edge = static_cast<double>((g.vertex_num() + 1) * sizeof(int) + wide.edge_num() * (id_bytes + w_bytes)) / wide.edge_num();
+	return r;
+}
+
+/*
+用LearnMetis的多层划分器划分g，写成与METIS输出相同格式的划分文件，再用read_partition读回，
+与实际使用METIS输出时的流程一致. g按无向图划分：出边与入边合并，去掉自环与重边，边权为1.
+失败时返回空.
+*/
+vector<int> partition_via_file(const Graph& g, int nparts, const std::string& path) {
+	int n = g.vertex_num();
+	vector<idx_t> xadj(1, 0), adjncy, nbrs;
+	for (int u = 0; u < n; ++u) {
+		nbrs.clear();
+		order::for_each_neighbor(g, u, [&](int v) { if (v != u) nbrs.push_back(v); });
+		std::sort(nbrs.begin(), nbrs.end());
+		nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+		adjncy.insert(adjncy.end(), nbrs.begin(), nbrs.end());
+		xadj.push_back(static_cast<idx_t>(adjncy.size()));
+	}
+	ThreadPool pool(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+	PartitionOptions opt;
+	opt.nparts = nparts;
+	PartitionResult res = multilevel_partition(n, 1, xadj.data(), adjncy.data(), nullptr, nullptr, pool, opt);
+	if (!save_partition(path, res.part)) return {};
+	vector<int> part = read_partition(path, n);
+	std::remove(path.c_str());
+	return part;
+}
+
+/*
+并发队列吞吐量：每个线程交替push/pop，key为上次出队值加随机增量(类似Dijkstra的单调性)，
+比较一把std::mutex保护的priority_queue与MultiQueue，两边都是惰性删除(重复元素直接入队)，语义一致.
+每行queries为千次操作数，ms_per_query即每千次操作的毫秒数.
+*/
+vector<Result> run_queue_throughput(int ops_per_thread) {
+	const int key_range = 1 << 20;
+	vector<Result> res;
+	int max_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+	for (int threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+		ThreadPool pool(threads);
+		int kilo_ops = static_cast<int>(2LL * ops_per_thread * threads / 1000);
+		for (bool relaxed : { false, true }) {
+			heap_counter::reset();
+			PriorityQueue1 locked_q;
+			std::mutex mtx;
+			MultiQueue mq(threads);
+			auto push = [&](int id, int dist) {
+				if (relaxed) {
+					mq.push(id, dist);
+					return;
+				}
+				std::lock_guard<std::mutex> lock(mtx);
+				locked_q.emplace(id, dist);
+			};
+			auto pop = [&](Vertex& v) {
+				if (relaxed) return mq.try_pop(v);
+				std::lock_guard<std::mutex> lock(mtx);
+				if (locked_q.empty()) return false;
+				v = locked_q.top();
+				locked_q.pop();
+				return true;
+			};
+			for (int i = 0; i < 1024 * threads; ++i) { push(i, i % 1000); } // 预先填充，避免队列为空
+			auto start = Clock::now();
+			pool.run([&](int tid) {
+				std::mt19937 rng(tid + 1);
+				int last = 0;
+				Vertex v;
+				for (int i = 0; i < ops_per_thread; ++i) {
+					push(static_cast<int>(rng() % key_range), last + static_cast<int>(rng() % 1000));
+					if (pop(v)) last = v.dist;
+				}
+			});
+			double ms = elapsed_ms(start);
+			res.push_back({ "queue-throughput", key_range, kilo_ops * 1000, relaxed ? "multiqueue" : "locked-priority-queue",
+				threads, kilo_ops, ms / kilo_ops, 0, 0, heap_counter::peak_kb(), 0, 0, 0 });
+		}
+		if (threads == max_threads) break;
+	}
+	return res;
+}
+
+void write_csv(std::ostream& os, const vector<Result>& results) {
+	os << "family,n,m,algorithm,threads,queries,ms_per_query,settled_per_query,queue_peak,peak_heap_kb,mismatch,cache_misses_per_query,bytes_per_edge" << endl;
+	for (auto& r : results) {
+		os << r.family << ',' << r.n << ',' << r.m << ',' << r.algorithm << ',' << r.threads << ',' << r.queries << ','
+			<< r.ms_per_query << ',' << r.settled_per_query << ',' << r.queue_peak << ',' << r.peak_heap_kb << ',' << r.mismatch << ',' << r.cache_misses_per_query << ',' << r.bytes_per_edge << endl;
+	}
+}
+
+void write_json(std::ostream& os, const vector<Result>& results) {
+	os << "[" << endl;
+	for (size_t i = 0; i < results.size(); ++i) {
+		auto& r = results[i];
+		os << "  {\"family\": \"" << r.family << "\", \"n\": " << r.n << ", \"m\": " << r.m
+			<< ", \"algorithm\": \"" << r.algorithm << "\", \"threads\": " << r.threads << ", \"queries\": " << r.queries
+			<< ", \"ms_per_query\": " << r.ms_per_query << ", \"settled_per_query\": " << r.settled_per_query
+			<< ", \"queue_peak\": " << r.queue_peak << ", \"peak_heap_kb\": " << r.peak_heap_kb
+			<< ", \"mismatch\": " << r.mismatch << ", \"cache_misses_per_query\": " << r.cache_misses_per_query << ", \"bytes_per_edge\": " << r.bytes_per_edge << "}" << (i + 1 < results.size() ? "," : "") << endl;
+	}
+	os << "]" << endl;
+}
+
+// 用法: ShortestPathBench [输出文件(.csv/.json，缺省输出CSV到屏幕)] [最大顶点数] [每组查询数]
+int main(int argc, char* argv[]) {
+	std::string out_path = argc > 1 ? argv[1] : "-";
+	int max_n = argc > 2 ? std::stoi(argv[2]) : 1000000;
+	int query_num = argc > 3 ? std::stoi(argv[3]) : 20;
+	const int max_w = 1000;
+
+	vector<Result> results;
+	for (const char* family : { "random", "grid", "rmat" }) {
+		for (int n = 1000; n <= max_n; n *= 10) {
+			GraphSpec spec{ family, n, 4 * n, max_w, 2021 };
+			Graph g = generate_graph(spec);
+			Bench bench(spec, g, query_num);
+			results.push_back(bench.run_policy<STLQueuePolicy>("stl-queue"));
+			if (spec.n <= 10000) { // 线性删除，规模大时过慢
+				results.push_back(bench.run_policy<STLSetPolicy>("stl-set"));
+			}
+			results.push_back(bench.run_policy<HandleSetPolicy>("handle-set"));
+			results.push_back(bench.run_policy<IndexedHeapPolicy>("indexed-heap"));
+			results.push_back(bench.run_policy<DaryHeapPolicy<4>>("dary-heap-4"));
+			results.push_back(bench.run_policy<DaryHeapPolicy<8>>("dary-heap-8"));
+			results.push_back(bench.run_policy<RadixHeapPolicy>("radix-heap"));
+			results.push_back(bench.run_workspace("workspace-query", [&](int s, int t, QueryWorkspace& ws) { return g.query(s, t, ws); }));
+			results.back().bytes_per_edge = static_cast<double>((spec.n + 1 + 2 * g.edge_num()) * sizeof(int)) / g.edge_num();
+			results.push_back(bench.run_workspace<BidirectionalWorkspace>("bidirectional", [&](int s, int t, BidirectionalWorkspace& ws) { return g.bidirectional_query(s, t, ws); }));
+
+			// 其他存储宽度：16位权重减少邻接表字节数，64位距离不会溢出
+			results.push_back(run_width<BasicGraph<uint32_t, uint16_t, uint32_t>>(bench, g, "width-u32-u16-u32"));
+			results.push_back(run_width<BasicGraph<uint32_t, uint32_t, uint64_t>>(bench, g, "width-u32-u32-u64"));
+
+			// 压缩邻接表：每条边的字节数与解码速度的权衡
+			for (auto scheme : { CompressedAdj::VARINT, CompressedAdj::STREAM_VBYTE }) {
+				CompressedAdj compressed = CompressedAdj::build(g.adjacency(), scheme);
+				results.push_back(bench.run_workspace(scheme == CompressedAdj::VARINT ? "compressed-varint" : "compressed-vbyte",
+					[&](int s, int t, QueryWorkspace& ws) { return compressed_query(compressed, s, t, ws); }));
+				results.back().bytes_per_edge = static_cast<double>(compressed.bytes()) / compressed.edge_num();
+			}
+
+			results.push_back(bench.run_cache("path-cache", query_num, 5));
+			results.push_back(bench.run_cache("path-cache-thrash", query_num / 2, 5));
+
+			heap_counter::reset();
+			ALT alt;
+			auto start = Clock::now();
+			alt.preprocess(g, 8);
+			results.push_back(bench.make("alt-preprocess", 1, elapsed_ms(start), 0, 0, 0, 1));
+			results.push_back(bench.run_workspace("alt", [&](int s, int t, QueryWorkspace& ws) { return alt.query(g, s, t, ws); }));
+
+			// CH在随机图、R-MAT上捷径多，n=3000时预处理已超过100秒，只在n=1000上校验正确性；类路网测到1e5
+			if (spec.n <= (spec.family == "grid" ? 100000 : 1000)) {
+				heap_counter::reset();
+				ContractionHierarchies ch;
+				start = Clock::now();
+				ch.preprocess(g);
+				results.push_back(bench.make("ch-preprocess", 1, elapsed_ms(start), 0, 0, 0, 1));
+				results.push_back(bench.run_ch(ch));
+			}
+
+			for (auto& r : bench.run_sssp(max_w / 10, std::min(query_num, 3))) { results.push_back(r); }
+
+			// 顶点重排：先随机打乱编号，再比较各种重排的查询时间与模拟缓存缺失
+			vector<int> shuffle(spec.n);
+			for (int v = 0; v < spec.n; ++v) { shuffle[v] = v; }
+			std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(spec.seed + 2));
+			Graph shuffled = permute_graph(g, shuffle);
+			vector<int> identity(spec.n);
+			for (int v = 0; v < spec.n; ++v) { identity[v] = v; }
+			results.push_back(bench.run_order("order-shuffled", shuffled, shuffle, identity));
+			results.push_back(bench.run_order("order-bfs", shuffled, shuffle, bfs_order(shuffled)));
+			results.push_back(bench.run_order("order-rcm", shuffled, shuffle, cuthill_mckee_order(shuffled)));
+			// 按划分分块：每块约256个顶点(与16x16的网格方块相当)，划分在打乱编号的图上进行，与对真实输入运行METIS相同
+			vector<int> part = partition_via_file(shuffled, std::max(2, spec.n / 256), "bench.part");
+			if (!part.empty()) {
+				results.push_back(bench.run_order("order-partition", shuffled, shuffle, partition_order(shuffled, part)));
+			}
+
+			// 快照：映射打开时检查CSR结构，O(V+E)；verify再计算全部数据的校验和
+			const char* snapshot = "bench.snap";
+			if (g.save_snapshot(snapshot)) {
+				for (bool verify : { false, true }) {
+					heap_counter::reset();
+					Graph mapped(0);
+					start = Clock::now();
+					bool ok = mapped.load_snapshot(snapshot, verify);
+					results.push_back(bench.make(verify ? "snapshot-verify" : "snapshot-open", 1, elapsed_ms(start), 0, 0, ok ? 0 : 1, 1));
+				}
+				std::remove(snapshot);
+			}
+		}
+	}
+
+	for (auto& r : run_queue_throughput(1000000)) { results.push_back(r); }
+
+	if (out_path == "-") {
+		write_csv(cout, results);
+		return 0;
+	}
+	std::ofstream out(out_path);
+	if (!out) {
+		cout << "打开文件失败！" << endl;
+		exit(1);
+	}
+	if (out_path.size() >= 5 && out_path.substr(out_path.size() - 5) == ".json") write_json(out, results);
+	else write_csv(out, results);
+	out.close();
+
+	return 0;
+}